@@ -0,0 +1,128 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+// Lookup throughput of AssetsCache against the vector scan it replaced.
+// Usage: Oneiro-Benchmark-AssetsCache [assets, 100000 by default]
+
+#include "Oneiro/Common/Assets/AssetInfo.hpp"
+#include "Oneiro/Common/Assets/AssetsCache.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	constexpr size_t DefaultAssetsCount = 100'000;
+	constexpr size_t LookupsCount = 1'000'000;
+	// The scan is O(n) per lookup, fewer lookups keep the run short and still give a stable average
+	constexpr size_t ScanLookupsCount = 2'000;
+
+	class BenchmarkAsset final : public oe::IAsset
+	{
+	public:
+		using IAsset::IAsset;
+
+		[[nodiscard]] bool IsLoaded() const noexcept override
+		{
+			return true;
+		}
+	};
+
+	// The provider cache before AssetsCache, a vector searched by hash
+	class VectorCache
+	{
+	public:
+		void Insert(const oe::Ref<oe::IAsset>& asset)
+		{
+			m_Assets.emplace_back(asset);
+		}
+
+		[[nodiscard]] oe::Ref<oe::IAsset> Find(size_t hash) const
+		{
+			const auto& found = std::find_if(m_Assets.begin(), m_Assets.end(), [hash](const auto& item) {
+				return item->GetAssetInfo()->GetHash() == hash;
+			});
+			return found != m_Assets.end() ? *found : nullptr;
+		}
+
+	private:
+		std::vector<oe::Ref<oe::IAsset>> m_Assets{};
+	};
+
+	// Nanoseconds per call of find, hits counts the lookups that found an asset so none of them are optimized out
+	template <class Func>
+	double Measure(const std::vector<size_t>& hashes, size_t lookupsCount, Func&& find, size_t& hits)
+	{
+		const auto start = std::chrono::steady_clock::now();
+		for (size_t i{}; i < lookupsCount; ++i)
+			hits += find(hashes[i % hashes.size()]) ? 1 : 0;
+		return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / lookupsCount;
+	}
+
+	void Report(std::string_view name, double nanoseconds)
+	{
+		fmt::print("{:<36} {:>10.1f} ns/lookup {:>10.2f} M lookups/s\n", name, nanoseconds, 1000.0 / nanoseconds);
+	}
+} // namespace
+
+int main(int argc, char** argv)
+{
+	const size_t assetsCount = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : DefaultAssetsCount;
+
+	std::vector<size_t> hashes(assetsCount);
+	for (size_t i{}; i < assetsCount; ++i)
+		hashes[i] = std::hash<std::string>{}(fmt::format("Assets/Textures/Texture{}.png", i));
+
+	oe::AssetsCache cache{};
+	VectorCache vectorCache{};
+	for (const auto hash : hashes)
+	{
+		auto asset = oe::CreateRef<BenchmarkAsset>(oe::AssetInfo::Create(hash), nullptr, oe::TypeId{});
+		cache.Insert(hash, asset);
+		vectorCache.Insert(asset);
+	}
+
+	// Lookups in random order, as requests from a streaming level would come
+	std::mt19937_64 random{42};
+	std::shuffle(hashes.begin(), hashes.end(), random);
+	auto misses = hashes;
+	for (auto& hash : misses)
+		hash = ~hash;
+
+	fmt::print("{} assets\n", assetsCount);
+
+	size_t hits{};
+	Report("Vector scan, hits", Measure(hashes, ScanLookupsCount, [&](size_t hash) { return vectorCache.Find(hash); }, hits));
+	Report("AssetsCache::Find, hits", Measure(hashes, LookupsCount, [&](size_t hash) { return cache.Find(hash) != oe::AssetsCache::InvalidSlot; }, hits));
+	Report("AssetsCache::FindAsset, hits", Measure(hashes, LookupsCount, [&](size_t hash) { return cache.FindAsset(hash); }, hits));
+	Report("AssetsCache::FindAsset, misses", Measure(misses, LookupsCount, [&](size_t hash) { return cache.FindAsset(hash); }, hits));
+
+	// Worker threads resolving assets at once only contend when they hit the same shard
+	const auto threadsCount = std::max(std::thread::hardware_concurrency(), 1u);
+	std::atomic<size_t> sharedHits{};
+	std::vector<std::thread> threads{};
+	const auto start = std::chrono::steady_clock::now();
+	for (size_t thread{}; thread < threadsCount; ++thread)
+	{
+		threads.emplace_back([&, thread] {
+			size_t threadHits{};
+			for (size_t i{}; i < LookupsCount; ++i)
+				threadHits += cache.FindAsset(hashes[(i + thread * 7919) % hashes.size()]) ? 1 : 0;
+			sharedHits += threadHits;
+		});
+	}
+	for (auto& thread : threads)
+		thread.join();
+	const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+	Report(fmt::format("AssetsCache::FindAsset, {} threads", threadsCount), elapsed / (LookupsCount * threadsCount));
+
+	fmt::print("{} hits\n", hits + sharedHits);
+	return 0;
+}
@@ -0,0 +1,102 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+// Cost of WorldSnapshots::Capture and Restore for a world of plain transforms.
+// Usage: Oneiro-Benchmark-WorldSnapshots [entities, 50000 by default]
+
+#include "Oneiro/Common/World/WorldSnapshots.hpp"
+
+#include <chrono>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+	constexpr size_t DefaultEntitiesCount = 50'000;
+	// Entities are spread over this many tables, so partial changes can share the pages of untouched tables
+	constexpr size_t TablesCount = 16;
+	constexpr size_t SnapshotsCapacity = 64;
+	constexpr size_t Iterations = 200;
+
+	// Average time of func in microseconds, prepare runs before every call and is not measured
+	template <class Prepare, class Func>
+	double Measure(Prepare&& prepare, Func&& func)
+	{
+		std::chrono::steady_clock::duration total{};
+		for (size_t i{}; i < Iterations; ++i)
+		{
+			prepare();
+			const auto start = std::chrono::steady_clock::now();
+			func();
+			total += std::chrono::steady_clock::now() - start;
+		}
+		return std::chrono::duration<double, std::micro>(total).count() / Iterations;
+	}
+
+	void Report(std::string_view name, double microseconds, size_t entitiesCount)
+	{
+		fmt::print("{:<32} {:>10.1f} us {:>8.1f} ns/entity\n", name, microseconds, microseconds * 1000.0 / entitiesCount);
+	}
+} // namespace
+
+int main(int argc, char** argv)
+{
+	const size_t entitiesCount = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : DefaultEntitiesCount;
+
+	oe::World world{};
+	auto* ecs = world.GetECS();
+
+	std::vector<flecs::entity> tags{};
+	for (size_t i{}; i < TablesCount; ++i)
+		tags.emplace_back(ecs->entity());
+
+	std::vector<flecs::entity> entities{};
+	entities.reserve(entitiesCount);
+	for (size_t i{}; i < entitiesCount; ++i)
+	{
+		auto entity = ecs->entity().add(tags[i % TablesCount]);
+		entity.set<oe::TransformComponent>({.position = {static_cast<float>(i), 0.0f, 0.0f}});
+		entities.emplace_back(entity);
+	}
+
+	auto moveQuery = ecs->query<oe::TransformComponent>();
+	const auto moveAll = [&] {
+		moveQuery.each([](oe::TransformComponent& transform) { transform.position.y += 1.0f; });
+	};
+	const auto moveOneTable = [&] {
+		for (size_t i{}; i < entities.size(); i += TablesCount)
+		{
+			auto transform = *entities[i].get<oe::TransformComponent>();
+			transform.position.y += 1.0f;
+			entities[i].set<oe::TransformComponent>(transform);
+		}
+	};
+
+	oe::WorldSnapshots<oe::TransformComponent> snapshots(&world, SnapshotsCapacity);
+	fmt::print("{} entities in {} tables, {} frames kept\n", entitiesCount, TablesCount, SnapshotsCapacity);
+
+	// The first pass over the ring allocates its pages, everything after it is steady state
+	for (size_t i{}; i < SnapshotsCapacity; ++i)
+	{
+		moveAll();
+		snapshots.Capture();
+	}
+
+	Report("Capture, every table changed", Measure(moveAll, [&] { snapshots.Capture(); }), entitiesCount);
+	Report("Capture, one table changed", Measure(moveOneTable, [&] { snapshots.Capture(); }), entitiesCount);
+	Report("Capture, nothing changed", Measure([] {}, [&] { snapshots.Capture(); }), entitiesCount);
+
+	// Restores the oldest frame still kept, as a rollback over the whole ring would
+	Report("Restore, same tables", Measure(moveAll, [&] { snapshots.Restore(snapshots.GetLatestFrame() + 1 - SnapshotsCapacity); }),
+		   entitiesCount);
+
+	// Entities that changed tables since the capture are restored one by one
+	const auto extraTag = ecs->entity();
+	const auto frame = snapshots.Capture();
+	for (size_t i{}; i < entities.size(); i += TablesCount)
+		entities[i].add(extraTag);
+	Report("Restore, one table moved", Measure([] {}, [&] { snapshots.Restore(frame); }), entitiesCount);
+	return 0;
+}
@@ -5,37 +5,130 @@
 
 #pragma once
 
+#include "Oneiro/Common/Assets/AssetHandle.hpp"
 #include "Oneiro/Common/Assets/AssetInfo.hpp"
+#include "Oneiro/Common/StringId.hpp"
 
-#define OE_MAKE_ASSET_HASH(x) std::hash<std::string>{}(x)
+#include <atomic>
+
+// Asset ids are StringIds, so their hashes are the same in every build and can be stored in cooked data
+#define OE_MAKE_ASSET_HASH(x) ::oe::StringId{x}.GetValue()
 
 namespace oe
 {
+	// Bytes held by a loaded asset, accounted by its provider against the provider budget
+	struct AssetMemoryUsage
+	{
+		size_t cpu{};
+		size_t gpu{};
+
+		AssetMemoryUsage& operator+=(const AssetMemoryUsage& other) noexcept
+		{
+			cpu += other.cpu;
+			gpu += other.gpu;
+			return *this;
+		}
+
+		AssetMemoryUsage& operator-=(const AssetMemoryUsage& other) noexcept
+		{
+			cpu -= other.cpu;
+			gpu -= other.gpu;
+			return *this;
+		}
+	};
+
+	// Timings of the last load of an asset in milliseconds, recorded by IAssetsProvider and AssetsStreamer for every provider
+	struct AssetLoadStats
+	{
+		// Hash of the asset whose load requested this one as a dependency, 0 when it was requested directly
+		size_t triggeredBy{};
+		// Time spent waiting in the streamer queues, for jobs or for dependencies
+		float queueWait{};
+		float read{};
+		float decode{};
+		float finalize{};
+		// GPU uploads providers spread over frames after finalizing
+		float upload{};
+		size_t diskSize{};
+		uint32_t loadsCount{};
+		bool isFailed{};
+		// Read through IAssetsProvider::ReadAssetAsync instead of a blocking read on a job
+		bool isAsyncRead{};
+
+		[[nodiscard]] float GetTotal() const noexcept
+		{
+			return queueWait + read + decode + finalize + upload;
+		}
+	};
+
 	class IAsset
 	{
 	public:
 		IAsset() = delete;
 		virtual ~IAsset() = default;
 
-		explicit IAsset(const Ref<AssetInfo>& assetInfo, void* ptr, size_t typeHash) : m_Info(assetInfo), nativePtr(ptr), m_TypeHash(typeHash) {}
+		explicit IAsset(const Ref<AssetInfo>& assetInfo, void* ptr, TypeId typeId) : m_Info(assetInfo), nativePtr(ptr), m_TypeId(typeId) {}
 
 		[[nodiscard]] virtual bool IsLoaded() const noexcept = 0;
 
 		template <class T>
 		[[nodiscard]] T* Get() const noexcept
 		{
-			if (typeid(T).hash_code() == m_TypeHash)
+			if (GetTypeId<T>() == m_TypeId)
 			{
-				return (T*)nativePtr;
+				Touch();
+				return static_cast<T*>(nativePtr.load(std::memory_order_acquire));
 			}
 			return nullptr;
 		}
 
+		// Type of the loaded data, the same type the provider of the asset is registered with
+		[[nodiscard]] TypeId GetDataType() const noexcept
+		{
+			return m_TypeId;
+		}
+
 		[[nodiscard]] const AssetInfo* GetAssetInfo() const noexcept
 		{
 			return m_Info.get();
 		}
 
+		[[nodiscard]] AssetInfo* GetAssetInfo() noexcept
+		{
+			return m_Info.get();
+		}
+
+		// Invalid until the asset is cached by its provider
+		[[nodiscard]] AssetHandle GetHandle() const noexcept
+		{
+			return m_Handle;
+		}
+
+		// Marks the asset as recently used, so eviction passes over it once more. Checked first, so hot assets touched
+		// from many threads do not keep writing the same cache line.
+		void Touch() const noexcept
+		{
+			if (!m_IsReferenced.load(std::memory_order_relaxed))
+				m_IsReferenced.store(true, std::memory_order_relaxed);
+		}
+
+		// Evicted assets stay cached without their data and are streamed again when requested
+		[[nodiscard]] bool IsEvicted() const noexcept
+		{
+			return m_IsEvicted.load(std::memory_order_acquire);
+		}
+
+		[[nodiscard]] const AssetMemoryUsage& GetMemoryUsage() const noexcept
+		{
+			return m_MemoryUsage;
+		}
+
+		// Main thread only, updated when a load completes
+		[[nodiscard]] const AssetLoadStats& GetLoadStats() const noexcept
+		{
+			return m_LoadStats;
+		}
+
 		bool operator==(size_t hash) const noexcept
 		{
 			return *m_Info == hash;
@@ -56,10 +149,21 @@ namespace oe
 			return !operator==(other);
 		}
 
-		void* nativePtr{};
+		// Set by FinalizeAsset on the main thread, the store publishes the loaded data to every other thread
+		std::atomic<void*> nativePtr{};
 
 	protected:
 		Ref<AssetInfo> m_Info{};
-		size_t m_TypeHash{};
+		TypeId m_TypeId{};
+
+	private:
+		friend class IAssetsProvider;
+		friend class AssetsCache;
+
+		AssetHandle m_Handle{};
+		AssetMemoryUsage m_MemoryUsage{};
+		AssetLoadStats m_LoadStats{};
+		mutable std::atomic<bool> m_IsReferenced{true};
+		std::atomic<bool> m_IsEvicted{};
 	};
 } // namespace oe
@@ -0,0 +1,52 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include "Oneiro/Common/Assets/AssetsProvider.hpp"
+
+#include <functional>
+#include <map>
+#include <vector>
+
+namespace oe
+{
+	// DAG of an asset and everything it depends on, collected from AssetInfo dependencies
+	class AssetDependencyGraph
+	{
+	public:
+		struct Node
+		{
+			IAssetsProvider* provider{};
+			Ref<IAsset> asset{};
+			std::vector<size_t> dependencies{}; // Indices of the nodes this one depends on
+		};
+
+		// Resolves a dependency to its provider and cached asset, returns {nullptr, nullptr} for unknown assets
+		using Resolver = std::function<std::pair<IAssetsProvider*, Ref<IAsset>>(const AssetDependency& dependency)>;
+
+		// Fails when a dependency can't be resolved or the dependencies form a cycle
+		bool Build(IAssetsProvider* provider, const Ref<IAsset>& root, const Resolver& resolver);
+
+		// Nodes in topological order, every node comes after all of its dependencies and the root is last
+		[[nodiscard]] const std::vector<Node>& GetNodes() const noexcept
+		{
+			return m_Nodes;
+		}
+
+	private:
+		enum class EVisitState : uint8_t
+		{
+			VISITING = 0,
+			VISITED
+		};
+
+		bool Visit(IAssetsProvider* provider, const Ref<IAsset>& asset, const Resolver& resolver, std::vector<AssetDependency>& path);
+
+		std::vector<Node> m_Nodes{};
+		// Keyed by type and hash, assets of different types may share an id
+		std::map<AssetDependency, std::pair<EVisitState, size_t>> m_Visited{};
+	};
+} // namespace oe
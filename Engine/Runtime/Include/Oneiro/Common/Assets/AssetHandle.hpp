@@ -0,0 +1,39 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include <cstdint>
+
+namespace oe
+{
+	// Weak reference to a cached asset: the slot index in its provider cache and the generation of that slot. A slot
+	// gets a new generation whenever its asset is removed, so stale handles resolve to nothing instead of another asset.
+	struct AssetHandle
+	{
+		uint32_t index{};
+		uint32_t generation{};
+
+		// Generations start at 1, the default handle never resolves
+		[[nodiscard]] constexpr bool IsValid() const noexcept
+		{
+			return generation != 0;
+		}
+
+		[[nodiscard]] constexpr uint64_t GetValue() const noexcept
+		{
+			return static_cast<uint64_t>(generation) << 32 | index;
+		}
+
+		[[nodiscard]] static constexpr AssetHandle FromValue(uint64_t value) noexcept
+		{
+			return {static_cast<uint32_t>(value), static_cast<uint32_t>(value >> 32)};
+		}
+
+		constexpr bool operator==(const AssetHandle&) const noexcept = default;
+	};
+
+	static_assert(sizeof(AssetHandle) == 8);
+} // namespace oe
@@ -6,30 +6,50 @@
 #pragma once
 
 #include "Oneiro/Common/Common.hpp"
+#include "Oneiro/Common/TypeId.hpp"
 
-#include <any>
+#include <compare>
+#include <mutex>
 #include <tuple>
+#include <vector>
 
 namespace oe
 {
+	template <class... Args>
+	class AssetDescriptor;
+
+	// Assets of different types may share an id, so a dependency names both
+	struct AssetDependency
+	{
+		TypeId type{};
+		size_t hash{};
+
+		auto operator<=>(const AssetDependency&) const = default;
+	};
+
 	class AssetInfo
 	{
 	public:
 		AssetInfo() = delete;
 
+		// The descriptor arguments live inline after the info, in the same allocation as the shared_ptr control block
 		template <class... Args>
-		explicit AssetInfo(size_t hash, Args... args) : m_Hash(hash), m_Data(std::make_any<std::tuple<Args...>>(std::make_tuple(args...)))
-		{
-		}
+		static Ref<AssetInfo> Create(size_t hash, Args... args);
 
 		template <class... Args>
-		const std::tuple<Args...>* GetData() const
-		{
-			return std::any_cast<std::tuple<Args...>>(&m_Data);
-		}
+		const std::tuple<Args...>* GetData() const noexcept;
 
 		[[nodiscard]] size_t GetHash() const noexcept;
 
+		// Assets (by type and hash) that must be loaded before this one is finalized. Thread safe, loader jobs may add
+		// dependencies to a shared info while another thread reads them.
+		void AddDependency(const AssetDependency& dependency);
+
+		// A copy, the dependencies may change while it is used
+		[[nodiscard]] std::vector<AssetDependency> GetDependencies() const;
+
+		[[nodiscard]] bool HasDependencies() const;
+
 		[[nodiscard]] bool operator==(size_t hash) const noexcept;
 
 		[[nodiscard]] bool operator!=(size_t hash) const noexcept;
@@ -38,8 +58,42 @@ namespace oe
 
 		[[nodiscard]] bool operator!=(AssetInfo& other) const noexcept;
 
+	protected:
+		AssetInfo(size_t hash, TypeId dataType) noexcept : m_Hash(hash), m_DataType(dataType) {}
+
 	private:
-		std::any m_Data{};
+		mutable std::mutex m_DependenciesMutex{};
+		std::vector<AssetDependency> m_Dependencies{};
 		size_t m_Hash{};
+		TypeId m_DataType{};
 	};
+
+	template <class... Args>
+	class AssetDescriptor final : public AssetInfo
+	{
+	public:
+		explicit AssetDescriptor(size_t hash, Args... args)
+			: AssetInfo(hash, GetTypeId<std::tuple<Args...>>()), m_Data(std::move(args)...)
+		{
+		}
+
+	private:
+		friend class AssetInfo;
+		std::tuple<Args...> m_Data;
+	};
+
+	template <class... Args>
+	Ref<AssetInfo> AssetInfo::Create(size_t hash, Args... args)
+	{
+		return CreateRef<AssetDescriptor<Args...>>(hash, std::move(args)...);
+	}
+
+	// Returns nullptr when the asset was created with different arguments
+	template <class... Args>
+	const std::tuple<Args...>* AssetInfo::GetData() const noexcept
+	{
+		if (m_DataType != GetTypeId<std::tuple<Args...>>())
+			return nullptr;
+		return &static_cast<const AssetDescriptor<Args...>*>(this)->m_Data;
+	}
 } // namespace oe
@@ -0,0 +1,432 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include "Oneiro/Common/Assets/Asset.hpp"
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+namespace oe
+{
+	// Maps asset hashes to slots of a dense asset array with an open addressing (linear probing) index.
+	// Slots never move once assigned, so a slot index is a stable handle until the asset is removed; freed slots are
+	// recycled with a new generation. Lookup and insertion are O(1) on average.
+	// The index is split into shards by hash, each behind its own reader/writer lock, so lookups and insertions may run
+	// on any thread and only contend when they hit the same shard. Slots are allocated in fixed pages that are never
+	// reallocated, so AssetHandle resolve, acquire and release are lock-free. Removal, iteration and Get belong to the
+	// main thread.
+	class AssetsCache
+	{
+	public:
+		static constexpr uint32_t InvalidSlot = std::numeric_limits<uint32_t>::max();
+
+		// Returns the cached asset: the given one when it was inserted, the one already cached under the hash when
+		// another thread got there first, or nullptr when the cache is full. The handle of the asset is set before any
+		// other thread can find it. An asset that is being unloaded is returned once the unload is done.
+		Ref<IAsset> Insert(size_t hash, const Ref<IAsset>& asset)
+		{
+			const auto mixed = Mix(hash);
+			auto& shard = GetShard(mixed);
+			while (true)
+			{
+				{
+					std::unique_lock lock(shard.mutex);
+					if ((shard.count + shard.tombstones + 1) * 2 > shard.buckets.size())
+					{
+						shard.Rehash(shard.count * 2 + 2 > shard.buckets.size() ? std::max<size_t>(shard.buckets.size() * 2, 16)
+																				: shard.buckets.size());
+					}
+
+					const auto mask = shard.buckets.size() - 1;
+					size_t tombstone = shard.buckets.size();
+					for (auto index = mixed & mask;; index = (index + 1) & mask)
+					{
+						auto& bucket = shard.buckets[index];
+						if (bucket.slot == EmptyBucket)
+						{
+							const auto slot = AllocateSlot(asset);
+							if (slot == InvalidSlot)
+								return nullptr;
+
+							auto& target = tombstone != shard.buckets.size() ? shard.buckets[tombstone] : bucket;
+							if (&target != &bucket)
+								--shard.tombstones;
+
+							target.hash = hash;
+							target.slot = slot;
+							++shard.count;
+							m_Count.fetch_add(1, std::memory_order_relaxed);
+							return asset;
+						}
+
+						if (bucket.slot == TombstoneBucket)
+						{
+							if (tombstone == shard.buckets.size())
+								tombstone = index;
+						}
+						else if (bucket.hash == hash)
+						{
+							if (!IsSlotLocked(bucket.slot))
+								return GetSlot(bucket.slot).asset;
+							break;
+						}
+					}
+				}
+				std::this_thread::yield();
+			}
+		}
+
+		[[nodiscard]] uint32_t Find(size_t hash) const
+		{
+			const auto mixed = Mix(hash);
+			auto& shard = GetShard(mixed);
+			std::shared_lock lock(shard.mutex);
+			const auto bucket = shard.FindBucket(hash, mixed);
+			return bucket != shard.buckets.size() ? shard.buckets[bucket].slot : InvalidSlot;
+		}
+
+		// Thread safe Find and Get, the reference is taken while the shard is locked, so removal can't race with it.
+		// An asset that is being unloaded is returned once the unload is done, never while its data is released.
+		[[nodiscard]] Ref<IAsset> FindAsset(size_t hash) const
+		{
+			const auto mixed = Mix(hash);
+			auto& shard = GetShard(mixed);
+			while (true)
+			{
+				{
+					std::shared_lock lock(shard.mutex);
+					const auto bucket = shard.FindBucket(hash, mixed);
+					if (bucket == shard.buckets.size())
+						return nullptr;
+
+					const auto slot = shard.buckets[bucket].slot;
+					if (!IsSlotLocked(slot))
+						return GetSlot(slot).asset;
+				}
+				// Unloads are short, the main thread unlocks the slot right after
+				std::this_thread::yield();
+			}
+		}
+
+		// Main thread only, empty for free slots. A slot is published by its pointer, so slots that other threads are
+		// filling in read as free.
+		[[nodiscard]] const Ref<IAsset>& Get(uint32_t slot) const noexcept
+		{
+			static const Ref<IAsset> Empty{};
+			const auto& target = GetSlot(slot);
+			return target.pointer.load(std::memory_order_acquire) ? target.asset : Empty;
+		}
+
+		[[nodiscard]] AssetHandle GetHandle(uint32_t slot) const noexcept
+		{
+			return {slot, GetSlot(slot).generation.load(std::memory_order_relaxed)};
+		}
+
+		// Lock-free. The asset stays alive while the handle is acquired, otherwise only until the main thread removes it
+		[[nodiscard]] IAsset* Resolve(AssetHandle handle) const noexcept
+		{
+			if (handle.index >= m_SlotsCount.load(std::memory_order_acquire))
+				return nullptr;
+
+			// The generation is checked again after the pointer is read, a slot reused in between is never returned
+			const auto& slot = GetSlot(handle.index);
+			if (slot.generation.load(std::memory_order_acquire) != handle.generation)
+				return nullptr;
+			auto* asset = slot.pointer.load(std::memory_order_acquire);
+			return slot.generation.load(std::memory_order_acquire) == handle.generation ? asset : nullptr;
+		}
+
+		// Lock-free. An acquired asset is never removed or evicted until it is released.
+		bool Acquire(AssetHandle handle) noexcept
+		{
+			if (handle.index >= m_SlotsCount.load(std::memory_order_acquire))
+				return false;
+
+			auto& slot = GetSlot(handle.index);
+			const auto references = slot.references.fetch_add(1, std::memory_order_acq_rel);
+			if ((references & RetiredBit) || slot.generation.load(std::memory_order_acquire) != handle.generation)
+			{
+				slot.references.fetch_sub(1, std::memory_order_release);
+				return false;
+			}
+			return true;
+		}
+
+		// Must pair with a successful Acquire
+		void Release(AssetHandle handle) noexcept
+		{
+			if (handle.index < m_SlotsCount.load(std::memory_order_acquire))
+				GetSlot(handle.index).references.fetch_sub(1, std::memory_order_release);
+		}
+
+		[[nodiscard]] bool IsAcquired(uint32_t slot) const noexcept
+		{
+			return (GetSlot(slot).references.load(std::memory_order_acquire) & ~RetiredBit) != 0;
+		}
+
+		// Makes acquires fail while the main thread unloads the asset, fails when it is already acquired. Locking and
+		// acquiring race on the same counter, so exactly one of them wins.
+		bool TryLockSlot(uint32_t slot) noexcept
+		{
+			uint32_t references{};
+			return GetSlot(slot).references.compare_exchange_strong(references, RetiredBit, std::memory_order_acq_rel);
+		}
+
+		// Main thread only, TryLockSlot that also fails while the asset is referenced outside of the cache. Checked with
+		// the shard locked, so no other thread can take a reference in between, and FindAsset and Insert wait for
+		// UnlockSlot instead of returning the asset.
+		bool TryLockSlotIfUnused(uint32_t slot)
+		{
+			if (slot >= GetSlotsCount() || !Get(slot))
+				return false;
+
+			const auto hash = Get(slot)->GetAssetInfo()->GetHash();
+			const auto mixed = Mix(hash);
+			auto& shard = GetShard(mixed);
+			std::unique_lock lock(shard.mutex);
+			const auto bucket = shard.FindBucket(hash, mixed);
+			if (bucket == shard.buckets.size() || shard.buckets[bucket].slot != slot || GetSlot(slot).asset.use_count() > 1)
+				return false;
+			return TryLockSlot(slot);
+		}
+
+		void UnlockSlot(uint32_t slot) noexcept
+		{
+			GetSlot(slot).references.fetch_and(~RetiredBit, std::memory_order_release);
+		}
+
+		// Main thread only, fails when the asset is acquired
+		bool Remove(size_t hash)
+		{
+			return Remove(hash, false);
+		}
+
+		bool RemoveSlot(uint32_t slot)
+		{
+			if (slot >= GetSlotsCount() || !Get(slot))
+				return false;
+			return Remove(Get(slot)->GetAssetInfo()->GetHash(), false);
+		}
+
+		// Main thread only, removes the asset only when the cache holds the last reference. Checked with the shard
+		// locked, so another thread can't find the asset in between.
+		bool RemoveSlotIfUnused(uint32_t slot)
+		{
+			if (slot >= GetSlotsCount() || !Get(slot))
+				return false;
+			return Remove(Get(slot)->GetAssetInfo()->GetHash(), true);
+		}
+
+		template <class Func>
+		void ForEach(Func&& func) const
+		{
+			for (uint32_t slot{}; slot < GetSlotsCount(); ++slot)
+			{
+				if (const auto& asset = Get(slot))
+					func(asset);
+			}
+		}
+
+		// Number of slots including free ones, indices are the slots returned by Insert and Find
+		[[nodiscard]] uint32_t GetSlotsCount() const noexcept
+		{
+			return m_SlotsCount.load(std::memory_order_acquire);
+		}
+
+		[[nodiscard]] size_t Size() const noexcept
+		{
+			return m_Count.load(std::memory_order_relaxed);
+		}
+
+	private:
+		static constexpr uint32_t EmptyBucket = std::numeric_limits<uint32_t>::max();
+		static constexpr uint32_t TombstoneBucket = EmptyBucket - 1;
+
+		static constexpr uint32_t PageShift = 10;
+		static constexpr uint32_t PageSize = 1u << PageShift;
+		static constexpr uint32_t MaxPages = 1024;
+		static constexpr uint32_t RetiredBit = 1u << 31;
+		// Shards are picked by the top bits of the mixed hash, buckets by the low ones
+		static constexpr uint32_t ShardShift = 5;
+		static constexpr uint32_t ShardsCount = 1u << ShardShift;
+
+		struct Bucket
+		{
+			size_t hash{};
+			uint32_t slot{EmptyBucket};
+		};
+
+		struct Slot
+		{
+			Ref<IAsset> asset{};
+			// Mirror of asset for lock-free resolve
+			std::atomic<IAsset*> pointer{};
+			std::atomic<uint32_t> generation{1};
+			// Acquire count, RetiredBit is set while the slot is free or locked
+			std::atomic<uint32_t> references{};
+		};
+
+		// Padded to a cache line, so threads working on neighbouring shards do not share one
+		struct alignas(64) Shard
+		{
+			mutable std::shared_mutex mutex{};
+			std::vector<Bucket> buckets{};
+			size_t count{};
+			size_t tombstones{};
+
+			[[nodiscard]] size_t FindBucket(size_t hash, size_t mixed) const noexcept
+			{
+				if (buckets.empty())
+					return 0;
+
+				const auto mask = buckets.size() - 1;
+				for (auto index = mixed & mask;; index = (index + 1) & mask)
+				{
+					const auto& bucket = buckets[index];
+					if (bucket.slot == EmptyBucket)
+						return buckets.size();
+					if (bucket.slot != TombstoneBucket && bucket.hash == hash)
+						return index;
+				}
+			}
+
+			void Rehash(size_t capacity)
+			{
+				std::vector<Bucket> rehashed(std::bit_ceil(capacity));
+				const auto mask = rehashed.size() - 1;
+				for (const auto& bucket : buckets)
+				{
+					if (bucket.slot == EmptyBucket || bucket.slot == TombstoneBucket)
+						continue;
+
+					auto index = Mix(bucket.hash) & mask;
+					while (rehashed[index].slot != EmptyBucket)
+						index = (index + 1) & mask;
+					rehashed[index] = bucket;
+				}
+				buckets = std::move(rehashed);
+				tombstones = 0;
+			}
+		};
+
+		// Asset hashes are not guaranteed to be well distributed in the low bits, finalize them before masking
+		static constexpr size_t Mix(size_t hash) noexcept
+		{
+			uint64_t value = hash;
+			value ^= value >> 33;
+			value *= 0xff51afd7ed558ccdull;
+			value ^= value >> 33;
+			value *= 0xc4ceb9fe1a85ec53ull;
+			value ^= value >> 33;
+			return static_cast<size_t>(value);
+		}
+
+		[[nodiscard]] Shard& GetShard(size_t mixed) const noexcept
+		{
+			return m_Shards[mixed >> (sizeof(size_t) * 8 - ShardShift)];
+		}
+
+		bool Remove(size_t hash, bool isUnusedOnly)
+		{
+			const auto mixed = Mix(hash);
+			auto& shard = GetShard(mixed);
+			std::unique_lock lock(shard.mutex);
+			const auto bucket = shard.FindBucket(hash, mixed);
+			if (bucket == shard.buckets.size())
+				return false;
+
+			const auto slot = shard.buckets[bucket].slot;
+			if (isUnusedOnly && GetSlot(slot).asset.use_count() > 1)
+				return false;
+
+			if (!TryLockSlot(slot))
+				return false;
+
+			FreeSlot(slot);
+			shard.buckets[bucket].slot = TombstoneBucket;
+			--shard.count;
+			++shard.tombstones;
+			m_Count.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+
+		// Buckets only point to allocated slots, so a retired bit there means locked for an unload
+		[[nodiscard]] bool IsSlotLocked(uint32_t slot) const noexcept
+		{
+			return (GetSlot(slot).references.load(std::memory_order_acquire) & RetiredBit) != 0;
+		}
+
+		[[nodiscard]] Slot& GetSlot(uint32_t slot) const noexcept
+		{
+			return m_Pages[slot >> PageShift][slot & (PageSize - 1)];
+		}
+
+		// Called with the shard of the asset locked
+		uint32_t AllocateSlot(const Ref<IAsset>& asset)
+		{
+			std::lock_guard lock(m_SlotsMutex);
+			uint32_t index{};
+			if (m_FreeSlots.empty())
+			{
+				index = m_SlotsCount.load(std::memory_order_relaxed);
+				if (index == MaxPages * PageSize)
+				{
+					OE_CORE_ERROR("Assets cache is full, {} assets at most!", MaxPages * PageSize);
+					return InvalidSlot;
+				}
+
+				if ((index & (PageSize - 1)) == 0)
+					m_Pages[index >> PageShift] = std::make_unique<Slot[]>(PageSize);
+			}
+			else
+			{
+				index = m_FreeSlots.back();
+				m_FreeSlots.pop_back();
+			}
+
+			// Everything is written before the pointer publishes the slot
+			auto& slot = GetSlot(index);
+			slot.asset = asset;
+			asset->m_Handle = {index, slot.generation.load(std::memory_order_relaxed)};
+			// Clears only the retired bit, stale acquires that are still backing out keep their count
+			slot.references.fetch_and(~RetiredBit, std::memory_order_release);
+			slot.pointer.store(asset.get(), std::memory_order_release);
+			if (index == m_SlotsCount.load(std::memory_order_relaxed))
+				m_SlotsCount.store(index + 1, std::memory_order_release);
+			return index;
+		}
+
+		void FreeSlot(uint32_t index)
+		{
+			// The generation changes first, so a concurrent resolve can never pair the old handle with a reused slot
+			auto& slot = GetSlot(index);
+			auto generation = slot.generation.load(std::memory_order_relaxed) + 1;
+			if (generation == 0)
+				generation = 1;
+			slot.generation.store(generation, std::memory_order_release);
+			slot.pointer.store(nullptr, std::memory_order_release);
+			slot.asset.reset();
+
+			std::lock_guard lock(m_SlotsMutex);
+			m_FreeSlots.emplace_back(index);
+		}
+
+		mutable std::array<Shard, ShardsCount> m_Shards{};
+		std::array<std::unique_ptr<Slot[]>, MaxPages> m_Pages{};
+		std::atomic<uint32_t> m_SlotsCount{};
+		std::mutex m_SlotsMutex{};
+		std::vector<uint32_t> m_FreeSlots{};
+		std::atomic<size_t> m_Count{};
+	};
+} // namespace oe
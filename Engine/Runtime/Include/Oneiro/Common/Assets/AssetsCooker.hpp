@@ -0,0 +1,133 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include "Oneiro/Common/Common.hpp"
+#include "Oneiro/Common/FileSystem/AsyncReader.hpp"
+#include "Oneiro/Common/FileSystem/Path.hpp"
+
+#include <cstddef>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace oe
+{
+	enum class ECookedAssetType : uint32_t
+	{
+		WORLD = 0,
+		TEXTURE,
+		SHADER
+	};
+
+	// Every cooked file starts with this header, the payload follows right after it
+	struct CookedAssetHeader
+	{
+		static constexpr uint32_t Magic = 0x4B43454F; // "OECK"
+
+		uint32_t magic{Magic};
+		ECookedAssetType type{};
+		uint32_t version{};
+		uint32_t reserved{};
+		uint64_t key{};
+		uint64_t payloadSize{};
+	};
+
+	static_assert(sizeof(CookedAssetHeader) == 32);
+
+	class AssetsPreloader;
+
+	// Converts one kind of source asset into its runtime format
+	class IAssetCooker
+	{
+	public:
+		virtual ~IAssetCooker() = default;
+
+		[[nodiscard]] virtual ECookedAssetType GetType() const noexcept = 0;
+
+		// Has to be bumped whenever the output changes, everything cooked by an older version is cooked again
+		[[nodiscard]] virtual uint32_t GetVersion() const noexcept = 0;
+
+		// Anything else the output depends on, hashed into the cache key
+		[[nodiscard]] virtual std::string GetSettings() const
+		{
+			return {};
+		}
+
+		// Runs on JobManager workers, the output must only depend on the path extension, the source and the settings
+		virtual bool Cook(const FileSystem::Path& path, std::span<const std::byte> source, std::vector<std::byte>& payload) const = 0;
+	};
+
+	// Cooks source assets into runtime formats. Cooked files keep the relative path and name of their source and carry
+	// an xxh3 key of the source, cooker version and settings, so unchanged assets are never cooked twice.
+	class AssetsCooker
+	{
+	public:
+		struct Stats
+		{
+			uint32_t cooked{};
+			uint32_t upToDate{};
+			uint32_t failed{};
+		};
+
+		// Extension with the leading dot, matched case insensitively
+		void RegisterCooker(const std::string& extension, const Ref<IAssetCooker>& cooker);
+
+		[[nodiscard]] const IAssetCooker* GetCooker(const FileSystem::Path& path) const;
+
+		// Cooks every source with a registered cooker under sourceDirectory into outputDirectory, in parallel
+		Stats CookDirectory(const FileSystem::Path& sourceDirectory, const FileSystem::Path& outputDirectory) const;
+
+		// Cooks the source into a complete cooked file, header included
+		bool Cook(const FileSystem::Path& path, std::span<const std::byte> source, std::vector<std::byte>& cooked) const;
+
+		// Reads the cooked asset through the file system and leaves only its payload in data. Sources that were not
+		// cooked are rejected, unless cooking on demand is enabled, which cooks them in memory. Cooked files written by
+		// another version of their cooker are rejected, they need a new --cook pass.
+		bool ReadCooked(const FileSystem::Path& path, ECookedAssetType type, std::string& data) const;
+		// isSource tells whether the file at path is the source rather than a cooked file, it is also true for missing
+		// files. Only sources may be written back to.
+		bool ReadCooked(const FileSystem::Path& path, ECookedAssetType type, std::string& data, bool& isSource) const;
+
+		// ReadCooked through FileSystem::ReadAsync, the callback runs on an IO thread, or on a JobManager worker when the
+		// source is cooked on demand. isSource is written before the callback runs.
+		bool ReadCookedAsync(const FileSystem::Path& path, ECookedAssetType type, std::string& data, FileSystem::ReadCallback callback,
+							 bool* isSource = nullptr) const;
+
+		[[nodiscard]] uint64_t GetCacheKey(const FileSystem::Path& path, const IAssetCooker& cooker, std::span<const std::byte> source) const;
+
+		// Enabled in debug builds (OE_DEBUG, off with NDEBUG), so edited sources are picked up without an offline cook.
+		// Set from ApplicationProperties::Engine::cookOnDemand at startup.
+		void SetCookOnDemand(bool isCookOnDemand) noexcept
+		{
+			m_IsCookOnDemand = isCookOnDemand;
+		}
+
+		[[nodiscard]] bool IsCookOnDemand() const noexcept
+		{
+			return m_IsCookOnDemand;
+		}
+
+		// Cooked files are recorded into and taken from the preloader before they are read from the file system
+		void SetPreloader(AssetsPreloader* preloader) noexcept
+		{
+			m_Preloader = preloader;
+		}
+
+	private:
+		// Strips the header of the cooked file in data, or cooks it when allowed
+		bool ProcessCooked(const FileSystem::Path& path, ECookedAssetType type, std::string& data, bool& isSource) const;
+		void FinishCookedAsync(const FileSystem::Path& path, ECookedAssetType type, std::string& data, FileSystem::ReadCallback callback,
+							   bool* isSource) const;
+		// Empty data counts as cooked, it needs no cooking
+		[[nodiscard]] static bool IsCooked(std::string_view data) noexcept;
+
+		std::unordered_map<std::string, Ref<IAssetCooker>> m_Cookers{};
+		AssetsPreloader* m_Preloader{};
+		bool m_IsCookOnDemand{OE_DEBUG};
+	};
+} // namespace oe
@@ -6,97 +6,295 @@
 #pragma once
 
 #include "Oneiro/Common/Assets/AssetInfo.hpp"
+#include "Oneiro/Common/Assets/AssetsCooker.hpp"
+#include "Oneiro/Common/Assets/AssetsPreloader.hpp"
 #include "Oneiro/Common/Assets/AssetsProvider.hpp"
+#include "Oneiro/Common/Assets/AssetsStreamer.hpp"
 #include "Oneiro/Common/Common.hpp"
 
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+
 namespace oe
 {
+	// Assets may be created, found, resolved and acquired from any thread. Loading, streaming and restreaming requested
+	// off the main thread is queued and started by the next Update, so only the main thread finalizes assets.
 	class AssetsManager
 	{
 	public:
+		AssetsManager();
+
 		template <class T, class... Args>
-		Ref<IAsset> CreateAsset(const std::string& id, Args... args)
+		Ref<IAsset> CreateAsset(StringId id, Args... args)
 		{
 			const auto& assetsProvider = GetAssetsProvider<T>();
 
 			const auto hash = OE_MAKE_ASSET_HASH(id);
-			auto asset = assetsProvider->CreateAsset(CreateRef<AssetInfo>(hash, args...));
-			assetsProvider->CacheAsset(asset);
+			auto asset = assetsProvider->CreateAsset(AssetInfo::Create(hash, args...));
+			if (assetsProvider->CacheAsset(asset) != asset)
+				OE_CORE_WARN("Asset with '{}' hash already in cache!", hash);
 			return asset;
 		}
 
 		template <class T, class... Args>
-		Ref<IAsset> CreateAssetAndLoad(const std::string& id, bool async, Args... args)
+		Ref<IAsset> CreateAssetAndLoad(StringId id, bool async, Args... args)
 		{
 			const auto& assetsProvider = GetAssetsProvider<T>();
 
 			const auto hash = OE_MAKE_ASSET_HASH(id);
-			auto asset = assetsProvider->CreateAsset(CreateRef<AssetInfo>(hash, args...));
-			assetsProvider->CacheAsset(asset);
-			assetsProvider->LoadAsset(asset, async);
+			auto asset = assetsProvider->CreateAsset(AssetInfo::Create(hash, args...));
+			if (assetsProvider->CacheAsset(asset) != asset)
+				OE_CORE_WARN("Asset with '{}' hash already in cache!", hash);
+			if (async)
+				StreamAsset(assetsProvider, asset);
+			else
+				LoadAsset(assetsProvider, asset);
 			return asset;
 		}
 
 		template <class T, class... Args>
-		Ref<IAsset> GetOrCreateAsset(const std::string& id, Args... args)
+		Ref<IAsset> GetOrCreateAsset(StringId id, Args... args)
 		{
 			const auto& assetsProvider = GetAssetsProvider<T>();
 
-			if (assetsProvider->IsAssetCached(OE_MAKE_ASSET_HASH(id)))
-				return GetAsset<T>(id);
-			return CreateAsset<T>(id, args...);
+			const auto hash = OE_MAKE_ASSET_HASH(id);
+			if (auto asset = assetsProvider->FindAsset(hash))
+			{
+				RestreamEvicted(assetsProvider, asset);
+				return asset;
+			}
+
+			// Threads racing to create the same asset all get the one that was cached first
+			return assetsProvider->CacheAsset(assetsProvider->CreateAsset(AssetInfo::Create(hash, args...)));
 		}
 
 		template <class T>
-		Ref<IAsset> GetAsset(const std::string& id)
+		Ref<IAsset> GetAsset(StringId id)
 		{
 			const auto& assetsProvider = GetAssetsProvider<T>();
 
-			return assetsProvider->GetAsset(OE_MAKE_ASSET_HASH(id));
+			auto asset = assetsProvider->GetAsset(OE_MAKE_ASSET_HASH(id));
+			if (asset)
+				RestreamEvicted(assetsProvider, asset);
+			return asset;
 		}
 
+		// Handles are plain values, cheaper to copy and store than Ref<IAsset> and stale handles resolve to nullptr
 		template <class T>
-		Ref<IAsset> LoadAsset(const std::string& id, bool async)
+		AssetHandle GetAssetHandle(StringId id)
 		{
-			const auto& assetsProvider = GetAssetsProvider<T>();
+			const auto asset = GetAsset<T>(id);
+			return asset ? asset->GetHandle() : AssetHandle{};
+		}
 
-			auto asset = GetAsset<T>(id);
-			if (!asset->IsLoaded())
-				assetsProvider->LoadAsset(asset, async);
+		// Lock-free, see AssetsCache::Resolve for how long the result stays valid
+		template <class T>
+		IAsset* ResolveAsset(AssetHandle handle)
+		{
+			return GetAssetsProvider<T>()->ResolveAsset(handle);
+		}
+
+		// Loaded data of the asset, nullptr while it is not loaded or the handle is stale
+		template <class T>
+		T* Resolve(AssetHandle handle)
+		{
+			auto* asset = ResolveAsset<T>(handle);
+			return asset ? asset->template Get<T>() : nullptr;
+		}
+
+		// Keeps the asset from being collected or evicted until ReleaseAsset, fails for stale handles
+		template <class T>
+		bool AcquireAsset(AssetHandle handle)
+		{
+			return GetAssetsProvider<T>()->AcquireAsset(handle);
+		}
+
+		template <class T>
+		void ReleaseAsset(AssetHandle handle)
+		{
+			GetAssetsProvider<T>()->ReleaseAsset(handle);
+		}
+
+		template <class T>
+		Ref<IAsset> LoadAsset(StringId id, bool async)
+		{
+			auto asset = GetAssetsProvider<T>()->GetAsset(OE_MAKE_ASSET_HASH(id));
+			if (asset)
+				LoadAsset<T>(asset, async);
 			return asset;
 		}
 
 		template <class T>
 		void LoadAsset(const Ref<IAsset>& asset, bool async)
 		{
-			const auto& assetsProvider = GetAssetsProvider<T>();
+			if (asset->IsLoaded())
+				return;
+
+			if (async)
+				StreamAsset<T>(asset);
+			else
+				LoadAsset(GetAssetsProvider<T>(), asset);
+		}
+
+		// Loads the asset and its dependencies in the background, callback runs on the main thread from Update. Off the main
+		// thread the request is queued until the next Update and nullptr is returned.
+		template <class T>
+		Ref<AssetStreamRequest> StreamAsset(const Ref<IAsset>& asset, float priority = 0.0f, AssetStreamCallback callback = {})
+		{
+			return StreamAsset(GetAssetsProvider<T>(), asset, priority, std::move(callback));
+		}
 
-			if (!asset->IsLoaded())
+		template <class T>
+		Ref<AssetStreamRequest> StreamAsset(StringId id, float priority = 0.0f, AssetStreamCallback callback = {})
+		{
+			auto asset = GetAsset<T>(id);
+			if (!asset)
+				return nullptr;
+			return StreamAsset<T>(asset, priority, std::move(callback));
+		}
+
+		// The asset is finalized only after the dependency is, the dependency has to be created before the asset is loaded
+		template <class T>
+		void AddDependency(const Ref<IAsset>& asset, StringId dependencyId)
+		{
+			const AssetDependency dependency{GetTypeId<T>(), OE_MAKE_ASSET_HASH(dependencyId)};
+			if (dependency == AssetDependency{asset->GetDataType(), asset->GetAssetInfo()->GetHash()})
 			{
-				assetsProvider->LoadAsset(asset, async);
+				OE_CORE_WARN("Asset with '{}' hash can't depend on itself!", dependency.hash);
+				return;
 			}
+			asset->GetAssetInfo()->AddDependency(dependency);
 		}
 
-		void LoadAssetsAsync();
+		// Called once per frame on the main thread, also evicts assets of providers over budget within the eviction time slice
+		void Update();
+
+		template <class T>
+		void SetMemoryBudget(const AssetMemoryBudget& budget)
+		{
+			GetAssetsProvider<T>()->SetMemoryBudget(budget);
+		}
+
+		void SetEvictionTimeSlice(std::chrono::microseconds timeSlice) noexcept
+		{
+			m_EvictionTimeSlice = timeSlice;
+		}
+
+		AssetsStreamer* GetStreamer() noexcept
+		{
+			return &m_Streamer;
+		}
+
+		// Providers read their assets through the cooker, so only cooked data reaches them
+		AssetsCooker* GetCooker() noexcept
+		{
+			return &m_Cooker;
+		}
+
+		// Records the asset files read from now on, in order, for Preload on later runs
+		void StartRecordingPreload()
+		{
+			m_Preloader.StartRecording();
+		}
+
+		bool StopRecordingPreload(const FileSystem::Path& manifestPath)
+		{
+			return m_Preloader.StopRecording(manifestPath);
+		}
+
+		// Reads the files of a recorded manifest in order in the background, ahead of the assets that need them
+		bool Preload(const FileSystem::Path& manifestPath)
+		{
+			return m_Preloader.Preload(manifestPath);
+		}
+
+		AssetsPreloader* GetPreloader() noexcept
+		{
+			return &m_Preloader;
+		}
 
 		void CollectGarbage();
 
+		// Visits every cached asset of every provider, main thread only
+		template <class Func>
+		void ForEachAsset(Func&& func) const
+		{
+			for (const auto& assetsProvider : m_AssetsProviders)
+				assetsProvider.second->GetCache().ForEach(func);
+		}
+
+		// Load stats of every cached asset, as CSV when the path ends with .csv and as JSON otherwise
+		void DumpLoadStats(const FileSystem::Path& path) const;
+
+		// Dumps the load stats every time the streamer becomes idle, e.g. at the end of a level load. Empty disables it.
+		void SetLoadReportPath(const FileSystem::Path& path)
+		{
+			m_LoadReportPath = path;
+		}
+
+		// Cancels streaming and drops every unused asset while the RHI is still alive
+		void Shutdown();
+
+		// Main thread only, providers are never unregistered, so the returned pointers stay valid
 		template <class T, class... Args>
-		void RegisterAssetsProvider(size_t assetTypeHash, const Args&... args)
+		void RegisterAssetsProvider(TypeId assetType, const Args&... args)
 		{
-			m_AssetsProviders.emplace(assetTypeHash, CreateRef<T>(args...));
+			std::unique_lock lock(m_AssetsProvidersMutex);
+			m_AssetsProviders.emplace(assetType, CreateRef<T>(args...));
 		}
 
 		template <class T>
 		IAssetsProvider* GetAssetsProvider()
 		{
-			const auto assetTypeHash = typeid(T).hash_code();
-			const auto& iter = m_AssetsProviders.find(assetTypeHash);
+			std::shared_lock lock(m_AssetsProvidersMutex);
+			const auto& iter = m_AssetsProviders.find(GetTypeId<T>());
 			if (iter != m_AssetsProviders.end())
 				return iter->second.get();
 			return nullptr;
 		}
 
-		std::unordered_map<size_t, Ref<IAssetsProvider>> m_AssetsProviders{};
+		[[nodiscard]] bool IsMainThread() const noexcept
+		{
+			return std::this_thread::get_id() == m_MainThreadId;
+		}
+
+	private:
+		struct DeferredStream
+		{
+			IAssetsProvider* provider{};
+			Ref<IAsset> asset{};
+			float priority{};
+			AssetStreamCallback callback{};
+		};
+
+		bool LoadAsset(IAssetsProvider* provider, const Ref<IAsset>& asset);
+		Ref<AssetStreamRequest> StreamAsset(IAssetsProvider* provider, const Ref<IAsset>& asset, float priority = 0.0f,
+											AssetStreamCallback callback = {});
+		std::pair<IAssetsProvider*, Ref<IAsset>> FindAsset(const AssetDependency& dependency) const;
+
+		// Evicted assets are streamed again on access, the streamer merges repeated requests while one is in flight
+		void RestreamEvicted(IAssetsProvider* provider, const Ref<IAsset>& asset)
+		{
+			if (asset->IsEvicted())
+				StreamAsset(provider, asset);
+		}
+
+		// Declared first, the streamer waits for its jobs on destruction and those read through the preloader
+		AssetsPreloader m_Preloader{};
+		AssetsCooker m_Cooker{};
+		AssetsStreamer m_Streamer{};
+
+		// Only written by the main thread, which iterates it without locking
+		std::unordered_map<TypeId, Ref<IAssetsProvider>> m_AssetsProviders{};
+		mutable std::shared_mutex m_AssetsProvidersMutex{};
+
+		std::thread::id m_MainThreadId{std::this_thread::get_id()};
+		std::mutex m_DeferredStreamsMutex{};
+		std::vector<DeferredStream> m_DeferredStreams{};
+
+		std::chrono::microseconds m_EvictionTimeSlice{250};
+		FileSystem::Path m_LoadReportPath{};
+		bool m_IsStreaming{};
 	};
 } // namespace oe
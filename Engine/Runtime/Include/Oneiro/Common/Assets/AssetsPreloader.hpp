@@ -0,0 +1,101 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include "Oneiro/Common/FileSystem/Path.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace oe
+{
+	// Records which files assets are read from, in order, and replays that order on later runs. A replayed manifest is
+	// read as one sequential stream on a JobManager worker ahead of the game, reads that find their file already
+	// prefetched skip the file system.
+	class AssetsPreloader
+	{
+	public:
+		struct Entry
+		{
+			std::string path{};
+			// Since the recording started
+			float time{};
+		};
+
+		AssetsPreloader() = default;
+		AssetsPreloader(const AssetsPreloader&) = delete;
+		AssetsPreloader& operator=(const AssetsPreloader&) = delete;
+		~AssetsPreloader();
+
+		// Every file read from now on is appended to the manifest, the first read of a file only
+		void StartRecording();
+
+		// Writes the recorded manifest, one "<ms>\t<path>" line per file
+		bool StopRecording(const FileSystem::Path& manifestPath);
+
+		[[nodiscard]] bool IsRecording() const noexcept
+		{
+			return m_IsRecording.load(std::memory_order_relaxed);
+		}
+
+		// Starts prefetching the files of the manifest in order, replaces a preload that is still running
+		bool Preload(const FileSystem::Path& manifestPath);
+
+		// Drops the prefetched data that was not taken yet
+		void Cancel();
+
+		// Once every file of the manifest was read, drops the prefetched data nobody took, e.g. files of assets that were
+		// not loaded this time. Returns false while the preload still reads ahead.
+		bool ReleaseUntaken();
+
+		// Main thread only: schedules the next batch of reads while the prefetched data is under the memory limit
+		void Update();
+
+		// Thread safe, called for every asset file read
+		void Record(const FileSystem::Path& path);
+
+		// Thread safe, moves the prefetched file into data. Files are handed out once, a file that is not prefetched yet
+		// is skipped by the preload, since the caller reads it anyway.
+		bool Take(const FileSystem::Path& path, std::string& data);
+
+		// Prefetched data that is not taken stays in memory, so reading ahead pauses above this limit
+		void SetMaxPrefetchedBytes(size_t bytes) noexcept
+		{
+			m_MaxPrefetchedBytes = bytes;
+		}
+
+		[[nodiscard]] bool IsPreloading() const noexcept;
+
+		[[nodiscard]] size_t GetPrefetchedBytes() const noexcept;
+
+	private:
+		void ReadBatch(size_t maxBytes);
+
+		mutable std::mutex m_Mutex{};
+
+		// Recording
+		std::vector<Entry> m_Recorded{};
+		std::unordered_set<std::string> m_RecordedPaths{};
+		std::chrono::steady_clock::time_point m_RecordingStart{};
+		std::atomic<bool> m_IsRecording{};
+
+		// Preloading
+		std::vector<Entry> m_Manifest{};
+		std::unordered_map<std::string, std::string> m_Prefetched{};
+		std::unordered_set<std::string> m_Taken{};
+		size_t m_NextEntry{};
+		size_t m_PrefetchedBytes{};
+		size_t m_MaxPrefetchedBytes{256ull << 20};
+		// Bumped by Cancel, so a batch that is still reading drops what it read for the old manifest
+		uint32_t m_Generation{};
+		std::atomic<bool> m_IsReading{};
+	};
+} // namespace oe
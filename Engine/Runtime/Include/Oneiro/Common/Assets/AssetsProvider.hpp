@@ -7,75 +7,275 @@
 
 #include "Oneiro/Common/Assets/Asset.hpp"
 #include "Oneiro/Common/Assets/AssetInfo.hpp"
+#include "Oneiro/Common/Assets/AssetsCache.hpp"
+#include "Oneiro/Common/FileSystem/AsyncReader.hpp"
 
-#include <execution>
-#include <future>
+#include <chrono>
+#include <string>
 
 namespace oe
 {
+	// Limits of the bytes held by the loaded assets of one provider, 0 means unlimited
+	struct AssetMemoryBudget
+	{
+		size_t cpu{};
+		size_t gpu{};
+	};
+
 	class IAssetsProvider
 	{
 	public:
+		virtual ~IAssetsProvider() = default;
+
 		virtual Ref<IAsset> CreateAsset(const Ref<AssetInfo>& assetInfo) = 0;
 
-		virtual void LoadAsset(const Ref<IAsset>& asset, bool async = false) = 0;
+		// Loading is split in stages so it can be streamed: ReadAsset (IO) and DecodeAsset run on JobManager workers and
+		// may only touch the asset they are given, FinalizeAsset runs on the main thread and publishes the result.
+		virtual bool ReadAsset(IAsset* asset, std::string& data) = 0;
+		virtual bool DecodeAsset(IAsset* asset, std::string& data) = 0;
+		virtual bool FinalizeAsset(IAsset* asset) = 0;
+
+		// Optional non-blocking ReadAsset, so the streamer can keep many reads in flight without a job per read. The
+		// callback may run on any thread. Returns false without calling it when the read has to go through ReadAsset.
+		virtual bool ReadAssetAsync(IAsset*, std::string&, FileSystem::ReadCallback)
+		{
+			return false;
+		}
+
+		// Bytes held by a finalized asset, queried once after FinalizeAsset
+		[[nodiscard]] virtual AssetMemoryUsage MeasureAsset(const IAsset*) const
+		{
+			return {};
+		}
+
+		// Releases the loaded data but keeps the asset cached, so it can be streamed again. Providers that do not
+		// override it never have their assets evicted. Lookups of the asset wait until it returns, so it must not look
+		// the asset up itself.
+		virtual bool UnloadAsset(IAsset*)
+		{
+			return false;
+		}
+
+		// Called once per frame on the main thread, after the streamer finalized its requests
+		virtual void Update() {}
 
-		virtual void LoadAssetsAsync() = 0;
+		// Releases what the provider holds besides its cache, before the RHI shuts down
+		virtual void Shutdown() {}
+
+		// FinalizeAsset followed by memory accounting, every loading path goes through it
+		bool CompleteAsset(IAsset* asset)
+		{
+			if (!FinalizeAsset(asset))
+				return false;
+
+			// Finalizing a loaded asset again replaces its data
+			RemeasureAsset(asset);
+			asset->m_IsReferenced.store(true, std::memory_order_relaxed);
+			asset->m_IsEvicted.store(false, std::memory_order_release);
+			return true;
+		}
 
-		void CacheAsset(const Ref<IAsset>& asset) noexcept
+		// Runs every stage on the calling thread
+		bool LoadAsset(const Ref<IAsset>& asset)
 		{
-			if (!IsAssetCached(asset))
+			std::string data{};
+			AssetLoadStats stats{};
+			auto stageStart = std::chrono::steady_clock::now();
+			const auto finishStage = [&](float& time) {
+				const auto now = std::chrono::steady_clock::now();
+				time = std::chrono::duration<float, std::milli>(now - stageStart).count();
+				stageStart = now;
+			};
+
+			auto result = ReadAsset(asset.get(), data);
+			finishStage(stats.read);
+			stats.diskSize = data.size();
+			if (result)
+			{
+				result = DecodeAsset(asset.get(), data);
+				finishStage(stats.decode);
+			}
+			if (result)
 			{
-				m_Cache.emplace_back(asset);
-				return;
+				result = CompleteAsset(asset.get());
+				finishStage(stats.finalize);
 			}
-			OE_CORE_WARN("Asset with '{}' hash already in cache!", asset->GetAssetInfo()->GetHash());
+
+			stats.isFailed = !result;
+			RecordLoadStats(asset.get(), stats);
+			if (!result)
+				OE_CORE_WARN("Failed to load asset with '{}' hash!", asset->GetAssetInfo()->GetHash());
+			return result;
+		}
+
+		// Main thread only, keeps the loads count and uploads already recorded for the asset
+		void RecordLoadStats(IAsset* asset, const AssetLoadStats& stats) noexcept
+		{
+			const auto loadsCount = asset->m_LoadStats.loadsCount;
+			asset->m_LoadStats = stats;
+			asset->m_LoadStats.loadsCount = loadsCount + 1;
+		}
+
+		// Thread safe. Returns the asset that ends up cached, which is another one when an asset with the same hash was
+		// cached first, or the given asset left uncached when the cache is full.
+		Ref<IAsset> CacheAsset(const Ref<IAsset>& asset)
+		{
+			auto cached = m_Cache.Insert(asset->GetAssetInfo()->GetHash(), asset);
+			return cached ? cached : asset;
+		}
+
+		// Lock-free, see AssetsCache::Resolve
+		[[nodiscard]] IAsset* ResolveAsset(AssetHandle handle) const noexcept
+		{
+			return m_Cache.Resolve(handle);
+		}
+
+		// Lock-free. Acquired assets are never collected or evicted, streaming code holds them across frames this way.
+		bool AcquireAsset(AssetHandle handle) noexcept
+		{
+			return m_Cache.Acquire(handle);
+		}
+
+		void ReleaseAsset(AssetHandle handle) noexcept
+		{
+			m_Cache.Release(handle);
 		}
 
 		[[nodiscard]] bool IsAssetCached(const Ref<IAsset>& asset) const noexcept
 		{
-			const auto hash = asset->GetAssetInfo()->GetHash();
-			const auto& found = std::find_if(m_Cache.begin(), m_Cache.end(), [&hash](const auto& item) {
-				return *item == hash;
-			});
-			return (found != m_Cache.end() && found->get());
+			return IsAssetCached(asset->GetAssetInfo()->GetHash());
+		}
+
+		[[nodiscard]] bool IsAssetCached(size_t hash) const
+		{
+			return m_Cache.Find(hash) != AssetsCache::InvalidSlot;
 		}
 
-		[[nodiscard]] bool IsAssetCached(size_t hash) const noexcept
+		// Same as GetAsset, but a missing asset is not an error. Thread safe.
+		[[nodiscard]] Ref<IAsset> FindAsset(size_t hash) const
 		{
-			const auto& found = std::find_if(m_Cache.begin(), m_Cache.end(), [&hash](const auto& item) {
-				return item->GetAssetInfo()->GetHash() == hash;
-			});
-			return (found != m_Cache.end() && found->get());
+			auto asset = m_Cache.FindAsset(hash);
+			if (asset)
+				asset->Touch();
+			return asset;
 		}
 
-		Ref<IAsset> GetAsset(size_t hash) const noexcept
+		Ref<IAsset> GetAsset(size_t hash) const
 		{
-			const auto& found = std::find_if(m_Cache.begin(), m_Cache.end(), [&hash](const auto& item) {
-				return *item == hash;
-			});
-			if (found != m_Cache.end())
+			auto asset = FindAsset(hash);
+			if (!asset)
+				OE_CORE_ERROR("Failed to find asset with '{}' hash!", hash);
+			return asset;
+		}
+
+		// Drops every asset that is only held by the cache and not acquired, main thread only
+		void CollectGarbage()
+		{
+			for (uint32_t slot{}; slot < m_Cache.GetSlotsCount(); ++slot)
 			{
-				return found.operator*();
+				const auto& asset = m_Cache.Get(slot);
+				if (!asset || asset.use_count() > 1)
+					continue;
+
+				const auto usage = asset->m_MemoryUsage;
+				if (m_Cache.RemoveSlotIfUnused(slot))
+					m_MemoryUsage -= usage;
 			}
-			OE_CORE_ERROR("Failed to find asset with '{}' hash!", hash);
-			return nullptr;
 		}
 
-		void CollectGarbage() noexcept
+		// Clock eviction: the hand sweeps the cache slots and unloads assets that were not touched since its last pass,
+		// until the provider is back under budget. Assets held outside of the cache (including in flight streaming
+		// requests) or acquired through their handle are in use and never evicted. Returns false when the deadline hit
+		// first, the next call continues from the same slot.
+		bool EvictAssets(std::chrono::steady_clock::time_point deadline)
 		{
-			for (auto iter = m_Cache.begin(); iter != m_Cache.end();)
+			const auto slotsCount = m_Cache.GetSlotsCount();
+
+			// The first sweep may only clear reference bits, a second one is enough to find every candidate
+			for (size_t visited{}; IsOverBudget() && visited < slotsCount * 2; ++visited)
 			{
-				iter = iter->use_count() <= 1 || iter->get() == nullptr ? m_Cache.erase(iter) : ++iter;
+				if ((visited & 31) == 31 && std::chrono::steady_clock::now() >= deadline)
+					return false;
+
+				if (m_ClockHand >= slotsCount)
+					m_ClockHand = 0;
+
+				const auto slot = m_ClockHand++;
+				const auto& asset = m_Cache.Get(slot);
+				if (!asset || asset.use_count() > 1 || !asset->IsLoaded())
+					continue;
+
+				if (asset->m_IsReferenced.exchange(false, std::memory_order_relaxed))
+					continue;
+
+				// Only assets that free memory of an exceeded budget are worth streaming again
+				const auto& usage = asset->m_MemoryUsage;
+				const auto isCpuOver = m_MemoryBudget.cpu && m_MemoryUsage.cpu > m_MemoryBudget.cpu;
+				const auto isGpuOver = m_MemoryBudget.gpu && m_MemoryUsage.gpu > m_MemoryBudget.gpu;
+				if (!(isCpuOver && usage.cpu) && !(isGpuOver && usage.gpu))
+					continue;
+
+				// Fails when another thread found the asset since the check above
+				if (!m_Cache.TryLockSlotIfUnused(slot))
+					continue;
+
+				const auto isUnloaded = UnloadAsset(asset.get());
+				m_Cache.UnlockSlot(slot);
+				if (!isUnloaded)
+					continue;
+
+				m_MemoryUsage -= usage;
+				asset->m_MemoryUsage = {};
+				asset->m_IsEvicted.store(true, std::memory_order_release);
 			}
+			return true;
 		}
 
-		const std::vector<Ref<IAsset>>& GetCache() const noexcept
+		void SetMemoryBudget(const AssetMemoryBudget& budget) noexcept
+		{
+			m_MemoryBudget = budget;
+		}
+
+		[[nodiscard]] const AssetMemoryBudget& GetMemoryBudget() const noexcept
+		{
+			return m_MemoryBudget;
+		}
+
+		[[nodiscard]] const AssetMemoryUsage& GetTotalMemoryUsage() const noexcept
+		{
+			return m_MemoryUsage;
+		}
+
+		[[nodiscard]] bool IsOverBudget() const noexcept
+		{
+			return (m_MemoryBudget.cpu && m_MemoryUsage.cpu > m_MemoryBudget.cpu) ||
+				   (m_MemoryBudget.gpu && m_MemoryUsage.gpu > m_MemoryBudget.gpu);
+		}
+
+		const AssetsCache& GetCache() const noexcept
 		{
 			return m_Cache;
 		}
 
+	protected:
+		// For providers that keep uploading after FinalizeAsset, e.g. over several frames
+		void AddUploadTime(IAsset* asset, float milliseconds) noexcept
+		{
+			asset->m_LoadStats.upload += milliseconds;
+		}
+
+		// For providers whose assets change size after they were finalized
+		void RemeasureAsset(IAsset* asset)
+		{
+			m_MemoryUsage -= asset->m_MemoryUsage;
+			asset->m_MemoryUsage = MeasureAsset(asset);
+			m_MemoryUsage += asset->m_MemoryUsage;
+		}
+
 	private:
-		std::vector<Ref<IAsset>> m_Cache;
+		AssetsCache m_Cache{};
+		AssetMemoryBudget m_MemoryBudget{};
+		AssetMemoryUsage m_MemoryUsage{};
+		uint32_t m_ClockHand{};
 	};
 } // namespace oe
@@ -0,0 +1,168 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include "Oneiro/Common/Assets/AssetsProvider.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace oe
+{
+	enum class EAssetStreamState : uint8_t
+	{
+		QUEUED = 0,
+		READING,
+		READ,
+		DECODING,
+		DECODED,
+		DONE,
+		FAILED,
+		CANCELLED
+	};
+
+	// Called on the main thread once the asset is finalized or failed to load, never for cancelled requests
+	using AssetStreamCallback = std::function<void(const Ref<IAsset>& asset, bool loaded)>;
+
+	class AssetStreamRequest
+	{
+	public:
+		AssetStreamRequest(IAssetsProvider* provider, Ref<IAsset> asset, float priority)
+			: m_Provider(provider), m_Asset(std::move(asset)), m_Priority(priority)
+		{
+		}
+
+		// Stale requests are dropped before their next stage starts, a stage already running on a worker finishes first
+		void Cancel() noexcept
+		{
+			m_IsCancelled.store(true);
+		}
+
+		// Requests with a lower value are served first, so the distance to the camera can be used directly
+		void SetPriority(float priority) noexcept
+		{
+			m_Priority.store(priority);
+		}
+
+		[[nodiscard]] float GetPriority() const noexcept
+		{
+			return m_Priority.load();
+		}
+
+		[[nodiscard]] bool IsCancelled() const noexcept
+		{
+			return m_IsCancelled.load();
+		}
+
+		[[nodiscard]] EAssetStreamState GetState() const noexcept
+		{
+			return m_State.load();
+		}
+
+		[[nodiscard]] bool IsDone() const noexcept
+		{
+			const auto state = GetState();
+			return state == EAssetStreamState::DONE || state == EAssetStreamState::FAILED || state == EAssetStreamState::CANCELLED;
+		}
+
+		[[nodiscard]] const Ref<IAsset>& GetAsset() const noexcept
+		{
+			return m_Asset;
+		}
+
+		// Recorded in the load stats of the asset, for dependencies streamed on behalf of another asset
+		void SetTriggeredBy(size_t hash) noexcept
+		{
+			m_Stats.triggeredBy = hash;
+		}
+
+	private:
+		friend class AssetsStreamer;
+
+		IAssetsProvider* m_Provider{};
+		Ref<IAsset> m_Asset{};
+		std::vector<AssetStreamCallback> m_Callbacks{};
+		std::vector<Ref<AssetStreamRequest>> m_Dependencies{};
+		std::string m_Data{};
+		// Written by the stage that owns the request, published to the main thread with the stage result
+		AssetLoadStats m_Stats{};
+		std::chrono::steady_clock::time_point m_RequestTime{std::chrono::steady_clock::now()};
+		std::atomic<float> m_Priority{};
+		std::atomic<bool> m_IsCancelled{};
+		std::atomic<EAssetStreamState> m_State{EAssetStreamState::QUEUED};
+	};
+
+	// Loads assets in the background on JobManager workers. Requests go through an IO stage (IAssetsProvider::ReadAsset)
+	// and a decode stage (IAssetsProvider::DecodeAsset) on workers, each capped to a number of concurrent jobs, and are
+	// finalized on the main thread by Update, which never waits for a worker.
+	class AssetsStreamer
+	{
+	public:
+		AssetsStreamer() = default;
+		AssetsStreamer(const AssetsStreamer&) = delete;
+		AssetsStreamer& operator=(const AssetsStreamer&) = delete;
+		~AssetsStreamer();
+
+		// Requesting an asset that is already streaming merges the requests and keeps the more urgent priority. When the
+		// streaming request was cancelled but a worker still reads or decodes the asset, the new request waits until the
+		// cancelled one is done, so an asset is never loaded twice at once.
+		// Reading and decoding overlap with the dependencies, but the asset is finalized only after all of them are done
+		// and fails if any of them fails. An asset that is already loaded is not loaded again, the returned request is done
+		// and the callback runs right away.
+		Ref<AssetStreamRequest> Request(IAssetsProvider* provider, const Ref<IAsset>& asset, float priority = 0.0f,
+										AssetStreamCallback callback = {}, const std::vector<Ref<AssetStreamRequest>>& dependencies = {});
+
+		// Main thread only: dispatches queued stages by priority, finalizes decoded assets and fires callbacks
+		void Update();
+
+		void CancelAll();
+
+		// Blocks until every request is done, for loading screens and shutdown
+		void Flush();
+		// Blocks until the request is done, other requests keep streaming meanwhile
+		void Flush(const Ref<AssetStreamRequest>& request);
+
+		void SetMaxIOJobs(uint32_t count) noexcept;
+		// Limit of reads queued through IAssetsProvider::ReadAssetAsync, which take no job while they wait for the disk
+		void SetMaxAsyncReads(uint32_t count) noexcept;
+		void SetMaxDecodeJobs(uint32_t count) noexcept;
+
+		[[nodiscard]] bool IsIdle() const noexcept;
+
+	private:
+		static void Merge(AssetStreamRequest& request, float priority, AssetStreamCallback&& callback,
+						  const std::vector<Ref<AssetStreamRequest>>& dependencies);
+		void OnStageFinished(const Ref<AssetStreamRequest>& request, EAssetStreamState state);
+		void Complete(const Ref<AssetStreamRequest>& request, EAssetStreamState state);
+		void Dispatch(std::vector<Ref<AssetStreamRequest>>& queue, std::atomic<uint32_t>& jobs, uint32_t maxJobs, bool decode);
+		bool DispatchAsyncRead(const Ref<AssetStreamRequest>& request);
+		void FinalizeReady();
+
+		std::vector<Ref<AssetStreamRequest>> m_ReadQueue{};
+		std::vector<Ref<AssetStreamRequest>> m_DecodeQueue{};
+		std::vector<Ref<AssetStreamRequest>> m_FinalizeQueue{};
+		std::unordered_map<const IAsset*, Ref<AssetStreamRequest>> m_Active{};
+		// Requests of assets whose active request is cancelled but not done yet, queued once it is
+		std::unordered_map<const IAsset*, Ref<AssetStreamRequest>> m_Chained{};
+
+		std::mutex m_FinishedMutex{};
+		std::vector<Ref<AssetStreamRequest>> m_Finished{};
+		std::vector<Ref<AssetStreamRequest>> m_FinishedSwap{};
+
+		std::atomic<uint32_t> m_IOJobs{};
+		std::atomic<uint32_t> m_DecodeJobs{};
+		std::atomic<uint32_t> m_AsyncReads{};
+		uint32_t m_MaxIOJobs{4};
+		uint32_t m_MaxAsyncReads{FileSystem::AsyncReader::MaxInFlight};
+		uint32_t m_MaxDecodeJobs{std::max(1u, std::thread::hardware_concurrency() / 2)};
+	};
+} // namespace oe
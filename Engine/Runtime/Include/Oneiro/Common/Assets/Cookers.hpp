@@ -0,0 +1,83 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include "Oneiro/Common/Assets/AssetsCooker.hpp"
+#include "Oneiro/Common/RHI/IShader.hpp"
+
+namespace oe
+{
+	// Json worlds (.oeworld) to the binary format read by World::LoadFromCooked
+	class WorldCooker : public IAssetCooker
+	{
+	public:
+		[[nodiscard]] ECookedAssetType GetType() const noexcept override
+		{
+			return ECookedAssetType::WORLD;
+		}
+
+		[[nodiscard]] uint32_t GetVersion() const noexcept override
+		{
+			return 1;
+		}
+
+		// The component layout, so changing a component recooks every world
+		[[nodiscard]] std::string GetSettings() const override;
+
+		bool Cook(const FileSystem::Path& path, std::span<const std::byte> source, std::vector<std::byte>& payload) const override;
+	};
+
+	// Payload: CookedTexture followed by width * height RGBA8 pixels, ready for ITexture::UpdateImage
+	struct CookedTexture
+	{
+		uint32_t width{};
+		uint32_t height{};
+		uint32_t channels{};
+		uint32_t reserved{};
+	};
+
+	// PNG, JPEG, TGA and BMP images, decoded once at cook time so the runtime never runs an image decoder
+	class TextureCooker : public IAssetCooker
+	{
+	public:
+		[[nodiscard]] ECookedAssetType GetType() const noexcept override
+		{
+			return ECookedAssetType::TEXTURE;
+		}
+
+		[[nodiscard]] uint32_t GetVersion() const noexcept override
+		{
+			return 1;
+		}
+
+		bool Cook(const FileSystem::Path& path, std::span<const std::byte> source, std::vector<std::byte>& payload) const override;
+	};
+
+	// Payload: CookedShader followed by the normalized source
+	struct CookedShader
+	{
+		RHI::EShaderStage stage{};
+		uint32_t sourceSize{};
+	};
+
+	// GLSL stages (.vert, .frag). The RHI compiles GLSL source, so cooking resolves the stage, normalizes line endings,
+	// strips comments and validates the #version directive, keeping line numbers intact for driver errors.
+	class ShaderCooker : public IAssetCooker
+	{
+	public:
+		[[nodiscard]] ECookedAssetType GetType() const noexcept override
+		{
+			return ECookedAssetType::SHADER;
+		}
+
+		[[nodiscard]] uint32_t GetVersion() const noexcept override
+		{
+			return 1;
+		}
+
+		bool Cook(const FileSystem::Path& path, std::span<const std::byte> source, std::vector<std::byte>& payload) const override;
+	};
+} // namespace oe
@@ -0,0 +1,124 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include "AssetsProvider.hpp"
+#include "Cookers.hpp"
+#include "Oneiro/Common/RHI/ITexture.hpp"
+
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <vector>
+
+namespace oe
+{
+	// Reuses pixel buffers between decodes, so streaming a level does not allocate and free a buffer per texture.
+	// Thread safe, buffers are acquired on JobManager workers and released on the main thread after the upload.
+	class TextureStagingPool
+	{
+	public:
+		std::vector<std::byte> Acquire(size_t size);
+		void Release(std::vector<std::byte>&& buffer);
+
+		// Bytes kept for reuse, larger releases are freed
+		void SetMaxPooledBytes(size_t bytes) noexcept;
+
+	private:
+		std::mutex m_Mutex{};
+		std::vector<std::vector<std::byte>> m_Buffers{};
+		size_t m_PooledBytes{};
+		size_t m_MaxPooledBytes{64ull << 20};
+	};
+
+	class TextureAssetsProvider;
+
+	class TextureAsset : public IAsset
+	{
+	public:
+		using IAsset::IAsset;
+
+		// True once every row is uploaded, Get<RHI::ITexture>() returns nullptr before that
+		[[nodiscard]] bool IsLoaded() const noexcept override;
+
+		// The uploaded texture, or the placeholder until the upload is done, so it can always be bound
+		[[nodiscard]] RHI::ITexture* GetTexture() const noexcept;
+
+	private:
+		friend class TextureAssetsProvider;
+		Ref<RHI::ITexture> m_Texture{};
+		const TextureAssetsProvider* m_Provider{};
+		CookedTexture m_Header{};
+		CookedTexture m_DecodedHeader{};
+		std::vector<std::byte> m_Staging{};
+		std::vector<std::byte> m_DecodedPixels{};
+		uint32_t m_UploadedRows{};
+		bool m_IsUploading{};
+	};
+
+	// Textures cooked by TextureCooker. Pixels are validated and copied into pooled staging memory on workers, the GPU
+	// texture is created on finalize and filled row by row from Update, limited to the upload budget per frame.
+	class TextureAssetsProvider : public IAssetsProvider
+	{
+	public:
+		// Registered on the main thread, which creates the placeholder right away when the RHI is up
+		TextureAssetsProvider();
+
+		Ref<IAsset> CreateAsset(const Ref<AssetInfo>& assetInfo) override;
+
+		bool ReadAsset(IAsset* asset, std::string& data) override;
+
+		bool ReadAssetAsync(IAsset* asset, std::string& data, FileSystem::ReadCallback callback) override;
+
+		bool DecodeAsset(IAsset* asset, std::string& data) override;
+
+		bool FinalizeAsset(IAsset* asset) override;
+
+		[[nodiscard]] AssetMemoryUsage MeasureAsset(const IAsset* asset) const override;
+
+		bool UnloadAsset(IAsset* asset) override;
+
+		void Update() override;
+
+		void Shutdown() override;
+
+		// Uploads every pending texture at once, e.g. behind a loading screen
+		void Flush();
+
+		void SetUploadBudget(size_t bytesPerFrame) noexcept
+		{
+			m_UploadBudget = bytesPerFrame;
+		}
+
+		[[nodiscard]] size_t GetPendingUploads() const noexcept
+		{
+			return m_Uploads.size();
+		}
+
+		TextureStagingPool* GetStagingPool() noexcept
+		{
+			return &m_StagingPool;
+		}
+
+		// Bound in place of textures that are still uploading, main thread only
+		[[nodiscard]] RHI::ITexture* GetPlaceholder() const noexcept
+		{
+			return m_Placeholder.get();
+		}
+
+	private:
+		// Uploads up to budget bytes of the texture, returns true when it is complete
+		bool Upload(TextureAsset* asset, size_t& budget);
+
+		// Main thread only, CreateAsset may run on any thread and never touches the RHI
+		void CreatePlaceholder();
+
+		TextureStagingPool m_StagingPool{};
+		std::deque<Ref<IAsset>> m_Uploads{};
+		Ref<RHI::ITexture> m_Placeholder{};
+		size_t m_UploadBudget{4ull << 20};
+	};
+} // namespace oe
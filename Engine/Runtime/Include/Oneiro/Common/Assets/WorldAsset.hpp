@@ -16,6 +16,12 @@ namespace oe
 		using IAsset::IAsset;
 
 		[[nodiscard]] bool IsLoaded() const noexcept override;
+
+	private:
+		friend class WorldAssetsProvider;
+		Ref<World> m_DecodedWorld{};
+		// Whether the world was read from its source, written by the read stage for the decode stage
+		bool m_IsSource{};
 	};
 
 	class WorldAssetsProvider : public IAssetsProvider
@@ -23,11 +29,12 @@ namespace oe
 	public:
 		Ref<IAsset> CreateAsset(const Ref<AssetInfo>& assetInfo) override;
 
-		void LoadAsset(const Ref<IAsset>& asset, bool async = false) override;
+		bool ReadAsset(IAsset* asset, std::string& data) override;
 
-		void LoadAssetsAsync() override;
+		bool ReadAssetAsync(IAsset* asset, std::string& data, FileSystem::ReadCallback callback) override;
 
-	private:
-		std::vector<IAsset*> mAssets2Load{};
+		bool DecodeAsset(IAsset* asset, std::string& data) override;
+
+		bool FinalizeAsset(IAsset* asset) override;
 	};
 } // namespace oe
@@ -7,13 +7,15 @@
 
 #include "Oneiro/Common/Common.hpp"
 #include "Oneiro/Common/FileSystem/ConfigFile.hpp"
+#include "Oneiro/Common/StringId.hpp"
 
 namespace oe
 {
 	class CVars
 	{
 	public:
-		void Load(const std::string& name, const FileSystem::Path& path)
+		// Configs are looked up by StringId, "Engine"_sid costs no hashing per lookup
+		void Load(StringId name, const FileSystem::Path& path)
 		{
 			m_Configs.emplace(name, CreateRef<FileSystem::ConfigFile>(path));
 		}
@@ -26,7 +28,7 @@ namespace oe
 			}
 		}
 
-		std::string GetString(const std::string& name, const std::string& key, const std::string& defaultValue = {})
+		std::string GetString(StringId name, const std::string& key, const std::string& defaultValue = {})
 		{
 			const auto& it = m_Configs.find(name);
 			if (it != m_Configs.end())
@@ -40,6 +42,6 @@ namespace oe
 		}
 
 	private:
-		std::unordered_map<std::string, Ref<FileSystem::ConfigFile>> m_Configs{};
+		std::unordered_map<StringId, Ref<FileSystem::ConfigFile>> m_Configs{};
 	};
 } // namespace oe
\ No newline at end of file
@@ -11,7 +11,11 @@
 #define OE_VERSION_MAJOR 1
 #define OE_VERSION_MINOR 0
 #define OE_VERSION_ALTER 0
+#ifdef NDEBUG
+#define OE_DEBUG 0
+#else
 #define OE_DEBUG 1
+#endif
 #define OE_ASSERTS 1
 
 #define SDL_MAIN_HANDLED
@@ -21,7 +25,7 @@ static constexpr std::string_view OE_VERSION_BUILD = "202305301948";
 static constexpr std::string_view OE_PLATFORM = "LINUX";
 static constexpr std::string_view OE_ARCH = "X86_64";
 static constexpr std::string_view OE_OPERATING_SYSTEM = "LINUX";
-static constexpr std::string_view OE_BUILD_MODE = "DEBUG";
+static constexpr std::string_view OE_BUILD_MODE = OE_DEBUG ? "DEBUG" : "RELEASE";
 
 static constexpr std::string_view OE_GIT_COMMIT_HASH = "4c22b48aa57f3ea6a2526aaf0ca8c26d56b0fb58";
 static constexpr std::string_view OE_GIT_COMMIT_DATE = "20230530123222";
@@ -12,9 +12,6 @@
 #include "Oneiro/Common/RHI/IRHI.hpp"
 #include "Oneiro/Common/WM/IWindowManager.hpp"
 
-#include "flecs.h"
-#include "flecs/addons/cpp/flecs.hpp"
-
 namespace oe
 {
 	class ModuleManager;
@@ -65,11 +62,6 @@ namespace oe
 			return m_Instance->assetsManager.get();
 		}
 
-		static flecs::world* GetECS()
-		{
-			return m_Instance->ecs.get();
-		}
-
 		static EngineApi* GetInstance()
 		{
 			return m_Instance;
@@ -83,7 +75,6 @@ namespace oe
 		Ref<CVars> cVars{};
 		Ref<WorldManager> worldManager{};
 		Ref<AssetsManager> assetsManager{};
-		Ref<flecs::world> ecs{};
 
 	private:
 		inline static EngineApi* m_Instance{};
@@ -0,0 +1,189 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include "Oneiro/Common/FileSystem/MappedFile.hpp"
+#include "Oneiro/Common/FileSystem/Path.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace oe::FileSystem
+{
+	enum class EArchiveCodec : uint8_t
+	{
+		NONE = 0,
+		LZ4, // Fast decode, for data needed at startup
+		ZSTD // Better ratio, for large and rarely loaded data
+	};
+
+	// .oepak layout (little endian):
+	//   ArchiveHeader
+	//   ArchiveEntry[entriesCount], sorted by path hash
+	//   entry paths, not null terminated
+	//   entry data, every entry starts at a multiple of the archive alignment
+	//
+	// Compressed entries are split into blocks of blockSize uncompressed bytes that are compressed independently.
+	// Their data starts with uint64_t offsets[blocksCount + 1] of the blocks relative to the entry data. A block that
+	// did not shrink is stored as is, which is detected by its stored size being equal to its uncompressed size.
+	struct ArchiveHeader
+	{
+		static constexpr uint32_t Magic = 0x4B50454F; // "OEPK"
+		static constexpr uint32_t CurrentVersion = 2;
+
+		uint32_t magic{Magic};
+		uint32_t version{CurrentVersion};
+		uint32_t entriesCount{};
+		uint32_t alignment{};
+		uint64_t namesOffset{};
+		uint64_t namesSize{};
+	};
+
+	struct ArchiveEntry
+	{
+		uint64_t hash{};
+		uint64_t offset{};
+		uint64_t size{}; // Stored size
+		uint64_t uncompressedSize{};
+		uint32_t nameOffset{};
+		uint32_t nameSize{};
+		uint32_t blockSize{};
+		EArchiveCodec codec{EArchiveCodec::NONE};
+		uint8_t reserved[3]{};
+
+		[[nodiscard]] uint64_t GetBlocksCount() const noexcept
+		{
+			return codec == EArchiveCodec::NONE ? 1 : (uncompressedSize + blockSize - 1) / blockSize;
+		}
+	};
+
+	static_assert(sizeof(ArchiveHeader) == 32 && sizeof(ArchiveEntry) == 48);
+
+	// Read only view of a memory mapped .oepak archive. Lookups are a binary search over the mapped index and reads
+	// return spans into the mapping, so they neither copy nor lock and are safe from any thread while the archive is open.
+	// Compressed entries are extracted with their blocks decoded in parallel on JobManager workers.
+	class Archive
+	{
+	public:
+		Archive() = default;
+		Archive(const Archive&) = delete;
+		Archive& operator=(const Archive&) = delete;
+		~Archive();
+
+		bool Open(const Path& path);
+		void Close() noexcept;
+
+		[[nodiscard]] const ArchiveEntry* GetEntry(std::string_view path) const noexcept;
+		[[nodiscard]] bool Contains(std::string_view path) const noexcept;
+
+		// Zero copy access to an uncompressed entry, empty for missing and compressed entries.
+		// The data stays valid until the archive is closed.
+		[[nodiscard]] std::span<const std::byte> Read(std::string_view path) const noexcept;
+		[[nodiscard]] std::span<const std::byte> Read(const ArchiveEntry& entry) const noexcept;
+
+		// Decompresses (or copies) the entry into destination, which has to hold entry.uncompressedSize bytes
+		bool Extract(const ArchiveEntry& entry, std::span<std::byte> destination) const;
+
+		// Decompresses a single block of blockSize bytes (fewer for the last one), for streaming large entries without
+		// extracting them whole. Uncompressed entries are one block.
+		bool ExtractBlock(const ArchiveEntry& entry, uint64_t block, std::span<std::byte> destination) const;
+
+		// Calls func(path, entry) for every entry in index order
+		template <class Func>
+		void ForEachEntry(Func&& func) const
+		{
+			for (const auto& entry : m_Entries)
+				func(GetEntryName(entry), entry);
+		}
+
+		[[nodiscard]] size_t GetEntriesCount() const noexcept
+		{
+			return m_Entries.size();
+		}
+
+		[[nodiscard]] bool IsOpen() const noexcept
+		{
+			return m_File.IsOpen();
+		}
+
+		// Hash of the normalized path: forward slashes, without leading "./" and "/"
+		[[nodiscard]] static uint64_t HashPath(std::string_view path) noexcept;
+		[[nodiscard]] static std::string NormalizePath(std::string_view path);
+
+	private:
+		[[nodiscard]] std::string_view GetEntryName(const ArchiveEntry& entry) const noexcept;
+		[[nodiscard]] std::span<const std::byte> GetEntryData(const ArchiveEntry& entry) const noexcept;
+		bool DecodeEntryBlock(const ArchiveEntry& entry, uint64_t block, std::span<std::byte> destination) const noexcept;
+
+		MappedFile m_File{};
+		std::span<const ArchiveEntry> m_Entries{};
+		std::string_view m_Names{};
+	};
+
+	// Packs files into a .oepak archive, used by tools at cook time
+	class ArchiveWriter
+	{
+	public:
+		static constexpr uint32_t MaxAlignment = 4096;
+
+		// Per file extension totals, the decode time comes from decoding every block once after compressing it,
+		// which also verifies the round trip
+		struct TypeStats
+		{
+			uint64_t entriesCount{};
+			uint64_t uncompressedSize{};
+			uint64_t storedSize{};
+			double decodeSeconds{};
+		};
+
+		using CodecSelector = std::function<EArchiveCodec(const Path& path, uint64_t size)>;
+
+		explicit ArchiveWriter(uint32_t alignment = 16, uint32_t blockSize = 256 * 1024);
+
+		// Fails when the path is already added or its hash collides with another entry
+		bool AddFile(std::string_view path, std::span<const std::byte> data, EArchiveCodec codec = EArchiveCodec::NONE);
+		bool AddFile(std::string_view path, const Path& sourcePath, EArchiveCodec codec = EArchiveCodec::NONE);
+
+		// Adds every file under the directory, paths are relative to it and prefixed with mountPoint.
+		// Without a selector the files are stored uncompressed.
+		bool AddDirectory(const Path& directory, std::string_view mountPoint = "", const CodecSelector& selector = {});
+
+		bool Save(const Path& path);
+
+		[[nodiscard]] const std::map<std::string, TypeStats>& GetStats() const noexcept
+		{
+			return m_Stats;
+		}
+
+		// Logs the compression ratio and decode throughput per file extension
+		void LogStats() const;
+
+	private:
+		struct Entry
+		{
+			uint64_t hash{};
+			std::string path{};
+			std::vector<std::byte> data{};
+			uint64_t uncompressedSize{};
+			EArchiveCodec codec{EArchiveCodec::NONE};
+		};
+
+		bool Compress(Entry& entry, std::span<const std::byte> data);
+
+		std::vector<Entry> m_Entries{};
+		std::map<std::string, TypeStats> m_Stats{};
+		std::unordered_map<uint64_t, size_t> m_Hashes{};
+		uint32_t m_Alignment{};
+		uint32_t m_BlockSize{};
+	};
+} // namespace oe::FileSystem
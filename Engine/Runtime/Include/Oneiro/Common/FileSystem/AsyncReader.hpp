@@ -0,0 +1,72 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace oe::FileSystem
+{
+	// Called once the read finished, dest is only valid when it gets true
+	using ReadCallback = std::function<void(bool)>;
+
+	// Reads whole files of the OS file system without blocking the caller. On Linux the reads go through io_uring: one
+	// thread keeps up to MaxInFlight opens and reads queued in the kernel and submits everything that arrived since its
+	// last wakeup in a single call. Where io_uring is missing or not permitted, reads run on a small pool of threads, the
+	// same as after the ring failed at runtime.
+	// Callbacks run on those IO threads, so they have to be short.
+	class AsyncReader
+	{
+	public:
+		static constexpr uint32_t MaxInFlight = 256;
+
+		explicit AsyncReader(uint32_t threadsCount = 4);
+		AsyncReader(const AsyncReader&) = delete;
+		AsyncReader& operator=(const AsyncReader&) = delete;
+		~AsyncReader();
+
+		// dest has to stay alive until the callback ran
+		void Read(std::string path, std::string& dest, ReadCallback callback);
+
+		// Runs the task on the thread pool, for reads that can't be handed to the kernel, e.g. from archives
+		void Run(std::function<void()> task);
+
+		// Blocks until every read and task finished
+		void Wait();
+
+		[[nodiscard]] bool IsUring() const noexcept;
+
+	private:
+		struct Request
+		{
+			std::string path{};
+			std::string* dest{};
+			ReadCallback callback{};
+		};
+
+		class Uring;
+
+		void RunThread();
+		void Finish();
+
+		std::unique_ptr<Uring> m_Uring{};
+
+		std::mutex m_Mutex{};
+		std::condition_variable m_Condition{};
+		std::condition_variable m_IdleCondition{};
+		std::deque<std::function<void()>> m_Tasks{};
+		std::vector<std::thread> m_Threads{};
+		size_t m_Pending{};
+		bool m_IsShouldExit{};
+	};
+} // namespace oe::FileSystem
@@ -0,0 +1,78 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <filesystem>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace oe::FileSystem
+{
+	// Replaces whole files of the OS file system on a background thread, so callers never wait for the disk. Every
+	// file is written next to its destination, synced and renamed over it, so a crash leaves either the old or the new
+	// file and never a partial one. The thread takes everything queued since its last wakeup as one batch: all files are
+	// written before the first sync, and each directory is synced once after the renames.
+	class AsyncWriter
+	{
+	public:
+		// Bounds the files that are open at once
+		static constexpr size_t MaxBatchSize = 64;
+
+		AsyncWriter();
+		AsyncWriter(const AsyncWriter&) = delete;
+		AsyncWriter& operator=(const AsyncWriter&) = delete;
+		// Commits everything that is queued
+		~AsyncWriter();
+
+		// A write to a path that is still queued replaces its data, the futures of both writes complete together.
+		// The future gets false when the file could not be replaced.
+		std::shared_future<bool> Write(const std::filesystem::path& path, std::string data);
+
+		// Blocks until every queued write is committed
+		void Wait();
+
+		// Blocks until the queued write of the path, if any, is committed
+		void Wait(const std::filesystem::path& path);
+
+		[[nodiscard]] bool IsIdle() const noexcept
+		{
+			return m_PendingCount.load(std::memory_order_acquire) == 0;
+		}
+
+		// Same commit on the calling thread, for writes when no writer is running
+		static bool WriteBlocking(const std::filesystem::path& path, const std::string& data);
+
+	private:
+		struct Request
+		{
+			std::filesystem::path path{};
+			std::string data{};
+			std::promise<bool> promise{};
+			std::shared_future<bool> future{};
+		};
+
+		void RunThread();
+		static void Commit(std::vector<Request>& batch);
+
+		std::mutex m_Mutex{};
+		std::condition_variable m_Condition{};
+		std::condition_variable m_IdleCondition{};
+		// Keyed by the path string, the order is kept separately so files are committed in the order they were queued
+		std::unordered_map<std::string, Request> m_Queued{};
+		std::deque<std::string> m_Order{};
+		std::unordered_map<std::string, std::shared_future<bool>> m_InFlight{};
+		std::atomic<size_t> m_PendingCount{};
+		std::thread m_Thread{};
+		bool m_IsShouldExit{};
+	};
+} // namespace oe::FileSystem
@@ -30,6 +30,7 @@ namespace oe::FileSystem
 
 		bool Open(const Path& path);
 
+		// Both queue the write on the writer thread and return right away
 		bool Save();
 
 		bool Save(const Path& path);
@@ -45,7 +46,11 @@ namespace oe::FileSystem
 		}
 
 	private:
+		[[nodiscard]] std::string Serialize() const;
+
 		rapidjson::Document m_File{};
 		Path m_Path{};
+		// What the file at m_Path holds, as far as this config knows
+		std::string m_SavedData{};
 	};
 } // namespace oe::FileSystem
\ No newline at end of file
@@ -0,0 +1,123 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace oe::FileSystem
+{
+	struct FileStat
+	{
+		uint64_t size{};
+		int64_t modifiedTime{}; // Seconds since the epoch, 0 for archived files
+		bool isDirectory{};
+		bool isArchived{};
+	};
+
+	struct DirectoryEntry
+	{
+		std::string name{};
+		FileStat stat{};
+	};
+
+	// In memory tree of every file and directory of the virtual file system, so exists, stat and list queries are a
+	// hash lookup instead of a syscall. FileSystem fills it on mount and keeps it in sync with its own writes, changes
+	// made by other programs are picked up by Watch (Linux only) or a rebuild. Thread safe.
+	class DirectoryIndex
+	{
+	public:
+		DirectoryIndex();
+		DirectoryIndex(const DirectoryIndex&) = delete;
+		DirectoryIndex& operator=(const DirectoryIndex&) = delete;
+		~DirectoryIndex();
+
+		void Clear();
+
+		// Adds the path and its missing parent directories, replaces the stat of an existing path
+		void Add(std::string_view path, const FileStat& stat);
+
+		// Removes the path and everything below it, except archived files. Archives are only dropped by a rebuild.
+		void Remove(std::string_view path);
+
+		[[nodiscard]] std::optional<FileStat> Stat(std::string_view path) const;
+		[[nodiscard]] bool IsExists(std::string_view path) const;
+
+		// Sorted by name, empty for files and missing directories
+		[[nodiscard]] std::vector<DirectoryEntry> List(std::string_view path) const;
+
+		// Directory of the OS file system that is visible under the mount point, used to map changes on the disk
+		// back to virtual paths
+		void AddMount(const std::filesystem::path& directory, std::string_view mountPoint);
+		void RemoveMount(const std::filesystem::path& directory);
+
+		// Updates the index from the disk for a file or directory of a mounted directory, which was written, created
+		// or removed. Paths outside of the mounted directories are ignored. Entries that other mounted directories or
+		// archives still provide are kept.
+		void Refresh(const std::filesystem::path& nativePath);
+
+		// Starts a thread that refreshes the index on changes inside of the mounted directories. Returns false where
+		// watching is not supported. Mounts, Watch and StopWatching are main thread only.
+		bool Watch();
+		void StopWatching();
+
+		[[nodiscard]] bool IsWatching() const noexcept
+		{
+			return m_Watcher != nullptr;
+		}
+
+		// Forward slashes, without leading "./" and "/" or a trailing "/". The root is an empty string.
+		[[nodiscard]] static std::string NormalizePath(std::string_view path);
+
+	private:
+		struct Node
+		{
+			FileStat stat{};
+			std::set<std::string, std::less<>> children{};
+		};
+
+		struct Mount
+		{
+			std::filesystem::path directory{};
+			std::string mountPoint{};
+		};
+
+		struct PathHash
+		{
+			using is_transparent = void;
+
+			size_t operator()(std::string_view path) const noexcept
+			{
+				return std::hash<std::string_view>{}(path);
+			}
+		};
+
+		class Watcher;
+
+		void AddLocked(const std::string& path, const FileStat& stat);
+		// Return false when archived files below the path kept it
+		bool RemoveLocked(const std::string& path);
+		bool RemoveNodeLocked(const std::string& path);
+		// The path and everything below it, parents before their children
+		[[nodiscard]] std::vector<std::string> GetPathsLocked(const std::string& path) const;
+		// Whether a mounted directory other than nativeDirectory has the path on the disk, takes the lock
+		[[nodiscard]] bool IsInOtherMount(const std::string& path, const std::filesystem::path& nativeDirectory) const;
+		[[nodiscard]] std::optional<std::string> GetVirtualPath(const std::filesystem::path& nativePath) const;
+
+		mutable std::shared_mutex m_Mutex{};
+		std::unordered_map<std::string, Node, PathHash, std::equal_to<>> m_Nodes{};
+		std::vector<Mount> m_Mounts{};
+		std::unique_ptr<Watcher> m_Watcher{};
+	};
+} // namespace oe::FileSystem
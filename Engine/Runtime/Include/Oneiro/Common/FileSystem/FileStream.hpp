@@ -0,0 +1,162 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include "Oneiro/Common/FileSystem/Path.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+struct PHYSFS_File;
+
+namespace oe::FileSystem
+{
+	// Reads a file of the virtual file system in chunks, so files of any size are processed with two buffers of memory.
+	// While the caller consumes one buffer, the next chunk is read into the other on the IO thread pool. Compressed
+	// archive entries are decoded block by block. A reader is used by one thread at a time.
+	class FileReader
+	{
+	public:
+		static constexpr size_t DefaultBufferSize = 1ull << 20;
+
+		FileReader();
+		FileReader(const FileReader&) = delete;
+		FileReader& operator=(const FileReader&) = delete;
+		~FileReader();
+
+		bool Open(const Path& path, size_t bufferSize = DefaultBufferSize);
+		void Close();
+
+		// Returns the number of bytes read, less than requested only at the end of the file or on errors
+		size_t Read(std::span<std::byte> destination);
+
+		template <class T>
+		bool Read(T& value)
+		{
+			static_assert(std::is_trivially_copyable_v<T>);
+			return Read(std::as_writable_bytes(std::span{&value, 1})) == sizeof(T);
+		}
+
+		// Positions past the end fail, buffered data is kept when the position stays inside of it
+		bool Seek(uint64_t position);
+		bool Skip(uint64_t bytes);
+
+		[[nodiscard]] uint64_t Tell() const noexcept
+		{
+			return m_Position;
+		}
+
+		[[nodiscard]] uint64_t GetSize() const noexcept
+		{
+			return m_Size;
+		}
+
+		[[nodiscard]] bool IsEof() const noexcept
+		{
+			return m_Position >= m_Size;
+		}
+
+		[[nodiscard]] bool IsOpen() const noexcept
+		{
+			return m_Source != nullptr;
+		}
+
+	private:
+		class Source;
+
+		struct Chunk
+		{
+			std::vector<std::byte> data{};
+			uint64_t offset{};
+			size_t size{};
+
+			[[nodiscard]] bool Contains(uint64_t position) const noexcept
+			{
+				return position >= offset && position < offset + size;
+			}
+		};
+
+		void Fill(uint64_t position);
+		void StartPrefetch(uint64_t offset);
+		void WaitPrefetch();
+
+		std::unique_ptr<Source> m_Source{};
+		Chunk m_Current{};
+		// Only touched by the IO thread while m_IsPrefetching is set
+		Chunk m_Next{};
+		uint64_t m_Position{};
+		uint64_t m_Size{};
+
+		std::mutex m_Mutex{};
+		std::condition_variable m_Condition{};
+		bool m_IsPrefetching{};
+	};
+
+	// Buffered writes to a file in the write directory (the base directory, same as FileSystem::Write). A full buffer is
+	// written on the IO thread pool while the caller keeps filling the other one. A writer is used by one thread at a time.
+	class FileWriter
+	{
+	public:
+		static constexpr size_t DefaultBufferSize = 1ull << 20;
+
+		FileWriter() = default;
+		FileWriter(const FileWriter&) = delete;
+		FileWriter& operator=(const FileWriter&) = delete;
+		~FileWriter();
+
+		// Truncates the file
+		bool Open(const Path& path, size_t bufferSize = DefaultBufferSize);
+
+		// Flushes, returns false when any write since Open failed
+		bool Close();
+
+		bool Write(std::span<const std::byte> data);
+
+		template <class T>
+		bool Write(const T& value)
+		{
+			static_assert(std::is_trivially_copyable_v<T>);
+			return Write(std::as_bytes(std::span{&value, 1}));
+		}
+
+		// Blocks until everything written so far reached the file
+		bool Flush();
+
+		[[nodiscard]] uint64_t Tell() const noexcept
+		{
+			return m_Position;
+		}
+
+		[[nodiscard]] bool IsOpen() const noexcept
+		{
+			return m_File != nullptr;
+		}
+
+	private:
+		void StartWrite();
+		void WaitWrite();
+
+		PHYSFS_File* m_File{};
+		std::string m_Path{};
+		std::vector<std::byte> m_Buffer{};
+		// Only touched by the IO thread while m_IsWriting is set
+		std::vector<std::byte> m_Pending{};
+		uint64_t m_Position{};
+		size_t m_BufferSize{};
+
+		std::mutex m_Mutex{};
+		std::condition_variable m_Condition{};
+		bool m_IsWriting{};
+		bool m_IsFailed{};
+	};
+} // namespace oe::FileSystem
@@ -6,19 +6,81 @@
 #pragma once
 
 #include "Oneiro/Common/Common.hpp"
+#include "Oneiro/Common/FileSystem/AsyncReader.hpp"
+#include "Oneiro/Common/FileSystem/AsyncWriter.hpp"
+#include "Oneiro/Common/FileSystem/DirectoryIndex.hpp"
 #include "Oneiro/Common/FileSystem/DynamicLibrary.hpp"
+#include "Oneiro/Common/FileSystem/MappedFile.hpp"
 #include "Oneiro/Common/FileSystem/Path.hpp"
 
+#include <span>
+
 namespace oe::FileSystem
 {
+	class Archive;
+	struct ArchiveEntry;
+
 	void Init();
 	void Shutdown();
 
+	// .oepak archives are memory mapped and searched before the loose files mounted through PhysFS. Reads that already
+	// found an archived file keep its archive alive when it is unmounted meanwhile.
 	void Mount(const Path& path, const std::string& mountPoint = "");
 	void UnMount(const Path& path);
 
+	// Files that the index misses are still looked up on disk and added to it, so files created by other programs
+	// stay readable without RefreshIndex
 	std::string Read(const Path& path);
+
+	// Reads the file into dest without blocking the caller, dest has to stay alive until the callback. Loose files go
+	// to the kernel through AsyncReader, archived files are extracted on its thread pool. The callback always runs on an
+	// IO thread, also when the file does not exist, and gets true for every file that was read, empty ones included.
+	void ReadAsync(const Path& path, std::string& dest, ReadCallback callback);
+
+	// Blocks until every ReadAsync finished
+	void WaitAsyncReads();
+
+	// Answered by the directory index that is built on mount, without touching the disk
+	[[nodiscard]] std::optional<FileStat> Stat(const Path& path);
+	[[nodiscard]] std::vector<DirectoryEntry> List(const Path& directory);
+
+	// Writes through FileSystem keep the index up to date. Files changed around it have to be refreshed by their path
+	// on the OS file system, or everything is rebuilt. Changes of other programs are picked up by watching.
+	void RefreshIndex();
+	void RefreshIndex(const std::filesystem::path& nativePath);
+	// Returns whether the mounted directories are watched now, watching is Linux only
+	bool WatchChanges(bool isEnabled);
+
+	// Path on the OS file system that Write and FileWriter write the file to
+	[[nodiscard]] std::filesystem::path GetWrittenPath(std::string_view path);
+
+	// Runs the task on the IO thread pool of ReadAsync, for blocking file work that should overlap with the caller
+	void RunAsync(std::function<void()> task);
+
+	// Zero copy alternative to Read for large files that are parsed once. Loose files are memory mapped and uncompressed
+	// archived files are views into the archive mapping, which hold the archive until they are closed. Compressed
+	// entries and files inside of PhysFS archives can't be mapped and are read into the buffer of the result.
+	// The result is not open when the file does not exist.
+	[[nodiscard]] MappedFile Map(const Path& path, EMapAccess access = EMapAccess::SEQUENTIAL);
+
+	// Zero copy read from a mounted archive, empty when the file is not archived or compressed (Read decompresses those).
+	// The span points into the archive, hold the Ref while using it, the same as for FindArchived.
+	[[nodiscard]] std::span<const std::byte> ReadArchived(const Path& path, Ref<Archive>& archive) noexcept;
+	[[nodiscard]] bool IsArchived(const Path& path) noexcept;
+
+	// Entry of the file in the first mounted archive that has it, or nullptr. The entry is owned by the archive, hold
+	// the Ref while using it.
+	[[nodiscard]] const ArchiveEntry* FindArchived(const Path& path, Ref<Archive>& archive) noexcept;
+
+	// Replaces the file in the write directory (the base directory) on the writer thread, see AsyncWriter. Reads and
+	// stats of the path wait for its queued write, so the caller sees its own writes.
 	void Write(const Path& path, const uint8_t* data, size_t size);
+	std::shared_future<bool> WriteAsync(const Path& path, std::string data);
+
+	// Blocks until every queued write is committed
+	void WaitAsyncWrites();
+	// Blocks until the queued write of the path, if any, is committed
+	void WaitAsyncWrite(const Path& path);
 
 	[[nodiscard]] bool IsInitialized() noexcept;
 } // namespace oe::FileSystem
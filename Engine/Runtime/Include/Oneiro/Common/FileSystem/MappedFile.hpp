@@ -0,0 +1,100 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include "Oneiro/Common/FileSystem/Path.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace oe::FileSystem
+{
+	// How the mapped pages are going to be touched, so the kernel can read ahead (or not)
+	enum class EMapAccess : uint8_t
+	{
+		NORMAL = 0,
+		SEQUENTIAL, // Parsed once from start to end, pages behind the reader can be dropped early
+		RANDOM		// Lookups, read ahead would only waste memory
+	};
+
+	// Read only view of a whole file. Files of the OS file system are memory mapped, so nothing is copied and pages
+	// are read by the kernel when they are first touched. Data that can't be mapped, e.g. compressed archive entries,
+	// is held in an owned buffer behind the same interface.
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+
+		// View into memory kept alive by owner, e.g. an entry of a mapped archive that holds a reference to the archive
+		MappedFile(std::span<const std::byte> data, std::shared_ptr<const void> owner) noexcept;
+		explicit MappedFile(std::string&& data) noexcept;
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		MappedFile(MappedFile&& other) noexcept;
+		MappedFile& operator=(MappedFile&& other) noexcept;
+		~MappedFile();
+
+		// Maps a file of the OS file system, an empty file opens without a mapping
+		bool Open(const Path& path, EMapAccess access = EMapAccess::NORMAL);
+		void Close() noexcept;
+
+		// Hints only, ignored for buffered data and where the OS has no equivalent
+		void Advise(EMapAccess access) const noexcept;
+
+		// Asks the kernel to start reading the range in the background, so the first touch does not stall on IO
+		void Prefetch(size_t offset = 0, size_t size = std::numeric_limits<size_t>::max()) const noexcept;
+
+		[[nodiscard]] std::span<const std::byte> GetData() const noexcept
+		{
+			if (m_IsBuffered)
+				return std::as_bytes(std::span{m_Buffer});
+			return {m_Data, m_Size};
+		}
+
+		[[nodiscard]] std::string_view GetString() const noexcept
+		{
+			const auto data = GetData();
+			return {reinterpret_cast<const char*>(data.data()), data.size()};
+		}
+
+		[[nodiscard]] size_t GetSize() const noexcept
+		{
+			return m_IsBuffered ? m_Buffer.size() : m_Size;
+		}
+
+		[[nodiscard]] bool IsOpen() const noexcept
+		{
+			return m_IsOpen;
+		}
+
+		// False when the data was copied into a buffer
+		[[nodiscard]] bool IsMapped() const noexcept
+		{
+			return m_IsOpen && !m_IsBuffered;
+		}
+
+		explicit operator bool() const noexcept
+		{
+			return m_IsOpen;
+		}
+
+	private:
+		std::string m_Buffer{};
+		const std::byte* m_Data{};
+		size_t m_Size{};
+		bool m_IsOpen{};
+		bool m_IsBuffered{};
+		// Views into memory of someone else are never unmapped, they only keep its owner alive
+		bool m_IsOwningMapping{};
+		std::shared_ptr<const void> m_Owner{};
+	};
+} // namespace oe::FileSystem
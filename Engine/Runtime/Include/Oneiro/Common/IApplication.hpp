@@ -5,6 +5,7 @@
 
 #pragma once
 
+#include "Oneiro/Common/Config.hpp"
 #include "Oneiro/Common/FileSystem/Path.hpp"
 #include "Oneiro/Common/WM/IWindow.hpp"
 
@@ -16,6 +17,22 @@ namespace oe
 		struct Engine
 		{
 			bool controlWorldState = true;
+
+			// Runs OnLogicUpdate and the worlds at a fixed tick rate; rendering interpolates between the last two steps
+			bool fixedTimeStep = false;
+			float fixedTickRate = 60.0f;
+			uint32_t maxFixedSteps = 5;
+
+			// Dedicated server mode (also enabled by the --headless argument): no window, RHI or ImGui, the worlds tick at
+			// fixedTickRate until SIGINT or SIGTERM is received
+			bool headless = false;
+
+			// Number of JobManager workers, 0 uses every hardware thread
+			uint32_t jobThreads = 0;
+
+			// Cooks source assets in memory when they are read, see AssetsCooker::SetCookOnDemand. Shipped builds read
+			// only assets cooked by a --cook pass, tools working on sources enable it in every build.
+			bool cookOnDemand = OE_DEBUG;
 		} engine;
 		FileSystem::Path projectFilePath{};
 	};
@@ -13,6 +13,7 @@
 #include <condition_variable>
 #include <functional>
 #include <future>
+#include <memory>
 #include <sstream>
 #include <thread>
 
@@ -62,11 +63,11 @@ namespace oe
 	class JobManager
 	{
 	public:
-		static void Initialize()
+		static void Initialize(uint32_t numThreads = 0)
 		{
 			m_FinishedLabel.store(0);
 
-			auto numCores = std::thread::hardware_concurrency();
+			auto numCores = numThreads ? numThreads : std::thread::hardware_concurrency();
 			m_NumThreads = std::max(1u, numCores);
 			for (uint32_t threadID = 0; threadID < m_NumThreads; ++threadID)
 			{
@@ -115,6 +116,54 @@ namespace oe
 			m_WakeCondition.notify_one();
 		}
 
+		// Same as AddTask, but fails instead of waiting when the job pool is full
+		static bool TryAddTask(const std::function<void()>& job)
+		{
+			m_CurrentLabel += 1;
+			if (!m_JobPool.push_back(job))
+			{
+				m_CurrentLabel -= 1;
+				return false;
+			}
+
+			m_WakeCondition.notify_one();
+			return true;
+		}
+
+		// Calls func(index) for every index in [0, count) on the workers and returns once all calls are done.
+		// The calling thread takes indices too and never waits for a job that has not started, so it is safe to call
+		// from inside a job.
+		template <class Func>
+		static void ParallelFor(size_t count, const Func& func)
+		{
+			struct State
+			{
+				std::atomic<size_t> next{};
+				std::atomic<size_t> finished{};
+			};
+
+			auto state = std::make_shared<State>();
+			const auto work = [state, count, &func] {
+				// Jobs that start after every index is taken return without touching func, which may be gone by then
+				for (auto index = state->next.fetch_add(1); index < count; index = state->next.fetch_add(1))
+				{
+					func(index);
+					state->finished.fetch_add(1);
+				}
+			};
+
+			const auto jobsCount = std::min<size_t>(count ? count - 1 : 0, m_NumThreads);
+			for (size_t i{}; i < jobsCount; ++i)
+			{
+				if (!TryAddTask(work))
+					break;
+			}
+
+			work();
+			while (state->finished.load() < count)
+				std::this_thread::yield();
+		}
+
 		static bool IsBusy()
 		{
 			return m_FinishedLabel.load() < m_CurrentLabel;
@@ -132,6 +181,11 @@ namespace oe
 			std::this_thread::yield();
 		}
 
+		[[nodiscard]] static uint32_t GetNumThreads() noexcept
+		{
+			return m_NumThreads;
+		}
+
 		static void Shutdown()
 		{
 			m_IsShouldExit = true;
@@ -144,7 +198,7 @@ namespace oe
 		inline static ThreadSafeRingBuffer<std::function<void()>, 256> m_JobPool;
 		inline static std::condition_variable m_WakeCondition{};
 		inline static std::mutex m_WakeMutex{};
-		inline static uint64_t m_CurrentLabel{};
+		inline static std::atomic<uint64_t> m_CurrentLabel{};
 		inline static std::atomic<uint64_t> m_FinishedLabel{};
 		inline static bool m_IsShouldExit{};
 	};
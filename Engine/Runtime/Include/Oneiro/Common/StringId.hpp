@@ -0,0 +1,100 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include "Oneiro/Common/Config.hpp"
+#include "Oneiro/Common/Utils.hpp"
+
+#include <compare>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace oe
+{
+	// FNV-1a hash of a string. The value is the same in every build, so it can be stored in cooked data and saves.
+	// Ids of literals ("WORLD"_sid) are always computed at compile time. Debug builds (OE_DEBUG, off with NDEBUG) intern
+	// every string hashed at runtime for reverse lookup and report collisions, literals keep their string and are
+	// interned on their first GetString, so a literal colliding with a runtime string is only reported from then on.
+	class StringId
+	{
+	public:
+		constexpr StringId() noexcept = default;
+
+		constexpr StringId(std::string_view string) noexcept : m_Value(Fnv1a64(string))
+		{
+#if OE_DEBUG
+			if (!std::is_constant_evaluated())
+				Intern(m_Value, string);
+#endif
+		}
+
+		constexpr StringId(const char* string) noexcept : StringId(std::string_view{string}) {}
+
+		StringId(const std::string& string) noexcept : StringId(std::string_view{string}) {}
+
+		[[nodiscard]] static constexpr StringId FromValue(uint64_t value) noexcept
+		{
+			StringId id{};
+			id.m_Value = value;
+			return id;
+		}
+
+		// Id of a string with static storage, hashed at compile time, see operator""_sid
+		[[nodiscard]] static consteval StringId FromLiteral(std::string_view literal) noexcept
+		{
+			StringId id{literal};
+#if OE_DEBUG
+			id.m_Literal = literal;
+#endif
+			return id;
+		}
+
+		[[nodiscard]] constexpr uint64_t GetValue() const noexcept
+		{
+			return m_Value;
+		}
+
+		// The interned string, empty in release builds and for ids made from a value that was never hashed at runtime
+		[[nodiscard]] std::string_view GetString() const;
+
+		constexpr bool operator==(const StringId& other) const noexcept
+		{
+			return m_Value == other.m_Value;
+		}
+
+		constexpr auto operator<=>(const StringId& other) const noexcept
+		{
+			return m_Value <=> other.m_Value;
+		}
+
+	private:
+		static void Intern(uint64_t value, std::string_view string) noexcept;
+
+		uint64_t m_Value{};
+#if OE_DEBUG
+		std::string_view m_Literal{};
+#endif
+	};
+
+	inline namespace Literals
+	{
+		consteval StringId operator""_sid(const char* string, size_t size) noexcept
+		{
+			return StringId::FromLiteral({string, size});
+		}
+	} // namespace Literals
+} // namespace oe
+
+template <>
+struct std::hash<oe::StringId>
+{
+	size_t operator()(oe::StringId id) const noexcept
+	{
+		return static_cast<size_t>(id.GetValue());
+	}
+};
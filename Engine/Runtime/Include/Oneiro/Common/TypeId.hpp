@@ -0,0 +1,24 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include "Oneiro/Common/Utils.hpp"
+
+#include "nameof.hpp"
+
+namespace oe
+{
+	// Identifies a type without RTTI. Computed from the type name at compile time, so it is the same in every module
+	// built by the same compiler and can be stored in serialized caches.
+	using TypeId = uint64_t;
+
+	template <class T>
+	constexpr TypeId GetTypeId() noexcept
+	{
+		constexpr auto id = Fnv1a64(nameof::nameof_type<T>());
+		return id;
+	}
+} // namespace oe
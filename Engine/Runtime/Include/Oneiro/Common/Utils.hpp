@@ -5,7 +5,9 @@
 
 #pragma once
 
+#include <cstdint>
 #include <memory>
+#include <string_view>
 
 #define OE_DECLARE_FLAG_TYPE(FLAG_TYPE, FLAG_BITS, BASE_TYPE)                                 \
                                                                                               \
@@ -91,4 +93,16 @@ namespace oe
 	{
 		return std::make_shared<T>(std::forward<Args>(args)...);
 	}
+
+	// 64-bit FNV-1a, stable across compilers and platforms, usable at compile time
+	constexpr uint64_t Fnv1a64(std::string_view value) noexcept
+	{
+		uint64_t hash{0xcbf29ce484222325ull};
+		for (const auto c : value)
+		{
+			hash ^= static_cast<uint8_t>(c);
+			hash *= 0x100000001b3ull;
+		}
+		return hash;
+	}
 } // namespace oe
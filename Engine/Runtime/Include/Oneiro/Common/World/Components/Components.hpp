@@ -5,4 +5,12 @@
 
 #pragma once
 
-#include "Oneiro/Common/World/Components/TransformComponent.hpp"
\ No newline at end of file
+#include "Oneiro/Common/World/Components/TransformComponent.hpp"
+
+#include <tuple>
+
+namespace oe
+{
+	// Components written to and read from world files, in the order they are stored
+	using SerializableComponents = std::tuple<TransformComponent>;
+} // namespace oe
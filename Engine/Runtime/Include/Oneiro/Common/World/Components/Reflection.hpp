@@ -0,0 +1,268 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include "glm/glm.hpp"
+
+#include "rapidjson/document.h"
+
+#include <cstddef>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+// Describes the fields of a plain component. Must be used inside namespace oe, right after the component definition:
+// OE_REFLECT_COMPONENT(MyComponent, OE_COMPONENT_FIELD(MyComponent, value, "Value"))
+// Editor hints (FieldHints) may follow the field name: OE_COMPONENT_FIELD(MyComponent, scale, "Scale", .resetValue = 1.0f)
+#define OE_REFLECT_COMPONENT(TYPE, ...)                                   \
+	template <>                                                           \
+	struct ComponentReflection<TYPE>                                      \
+	{                                                                     \
+		static constexpr std::string_view name = #TYPE;                   \
+		static constexpr auto fields = std::make_tuple(__VA_ARGS__);      \
+	};
+
+#define OE_COMPONENT_FIELD(TYPE, MEMBER, NAME, ...)                       \
+	::oe::ComponentField<TYPE, decltype(TYPE::MEMBER)>                    \
+	{                                                                     \
+		NAME, &TYPE::MEMBER __VA_OPT__(, ::oe::FieldHints{__VA_ARGS__})   \
+	}
+
+namespace oe
+{
+	// How the editor shows a field, the serializers ignore them
+	struct FieldHints
+	{
+		// Set by the per axis reset buttons of vector fields
+		float resetValue{};
+		// Stored in radians, edited in degrees
+		bool isAngle{};
+	};
+
+	template <class T, class TField>
+	struct ComponentField
+	{
+		using Type = TField;
+
+		std::string_view name;
+		TField T::*member;
+		FieldHints hints{};
+	};
+
+	template <class T>
+	struct ComponentReflection;
+
+	template <class T>
+	concept ReflectedComponent = requires { ComponentReflection<T>::fields; };
+
+	// Components stored in tables are copied with memcpy for snapshots and bulk copies, so they must stay plain data
+	template <class T>
+	concept PlainComponent = std::is_trivially_copyable_v<T> && std::is_standard_layout_v<T>;
+
+	template <ReflectedComponent T>
+	constexpr std::string_view GetComponentName() noexcept
+	{
+		return ComponentReflection<T>::name;
+	}
+
+	// Calls func(name, field) for every reflected field, used by serializers and editor inspectors alike
+	template <ReflectedComponent T, class Func>
+	constexpr void ForEachField(T& component, Func&& func)
+	{
+		std::apply([&](const auto&... fields) { (func(fields.name, component.*(fields.member)), ...); }, ComponentReflection<T>::fields);
+	}
+
+	template <ReflectedComponent T, class Func>
+	constexpr void ForEachField(const T& component, Func&& func)
+	{
+		std::apply([&](const auto&... fields) { (func(fields.name, component.*(fields.member)), ...); }, ComponentReflection<T>::fields);
+	}
+
+	template <PlainComponent T>
+	void CopyComponents(T* destination, const T* source, size_t count) noexcept
+	{
+		std::memcpy(destination, source, count * sizeof(T));
+	}
+
+	namespace Reflection
+	{
+		template <class T>
+		void SerializeValue(const T& value, rapidjson::Value& out, rapidjson::Document::AllocatorType& allocator)
+		{
+			if constexpr (std::is_same_v<T, bool>)
+				out.SetBool(value);
+			else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+				out.SetInt64(static_cast<int64_t>(value));
+			else if constexpr (std::is_integral_v<T>)
+				out.SetUint64(static_cast<uint64_t>(value));
+			else if constexpr (std::is_floating_point_v<T>)
+				out.SetDouble(static_cast<double>(value));
+			else if constexpr (std::is_same_v<T, std::string>)
+				out.SetString(value.c_str(), static_cast<rapidjson::SizeType>(value.size()), allocator);
+			else if constexpr (requires { T::length(); })
+			{
+				out.SetArray();
+				for (glm::length_t i{}; i < T::length(); ++i)
+					out.PushBack(static_cast<double>(value[i]), allocator);
+			}
+			else
+				static_assert(!sizeof(T), "Field type is not supported by the component serializer");
+		}
+
+		template <class T>
+		bool DeserializeValue(T& value, const rapidjson::Value& in)
+		{
+			if constexpr (std::is_same_v<T, bool>)
+			{
+				if (!in.IsBool())
+					return false;
+				value = in.GetBool();
+			}
+			else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>)
+			{
+				if (!in.IsInt64())
+					return false;
+				value = static_cast<T>(in.GetInt64());
+			}
+			else if constexpr (std::is_integral_v<T>)
+			{
+				if (!in.IsUint64())
+					return false;
+				value = static_cast<T>(in.GetUint64());
+			}
+			else if constexpr (std::is_floating_point_v<T>)
+			{
+				if (!in.IsNumber())
+					return false;
+				value = static_cast<T>(in.GetDouble());
+			}
+			else if constexpr (std::is_same_v<T, std::string>)
+			{
+				if (!in.IsString())
+					return false;
+				value.assign(in.GetString(), in.GetStringLength());
+			}
+			else if constexpr (requires { T::length(); })
+			{
+				if (!in.IsArray() || in.Size() != static_cast<rapidjson::SizeType>(T::length()))
+					return false;
+				for (glm::length_t i{}; i < T::length(); ++i)
+				{
+					if (!in[i].IsNumber())
+						return false;
+					value[i] = static_cast<typename T::value_type>(in[i].GetDouble());
+				}
+			}
+			else
+				static_assert(!sizeof(T), "Field type is not supported by the component serializer");
+			return true;
+		}
+
+		// Binary layout of cooked assets: trivially copyable values as raw bytes, strings prefixed with their uint32_t size
+		template <class T>
+		void WriteValue(const T& value, std::vector<std::byte>& out)
+		{
+			if constexpr (std::is_same_v<T, std::string>)
+			{
+				WriteValue(static_cast<uint32_t>(value.size()), out);
+				const auto* data = reinterpret_cast<const std::byte*>(value.data());
+				out.insert(out.end(), data, data + value.size());
+			}
+			else if constexpr (std::is_trivially_copyable_v<T>)
+			{
+				const auto* data = reinterpret_cast<const std::byte*>(&value);
+				out.insert(out.end(), data, data + sizeof(T));
+			}
+			else
+				static_assert(!sizeof(T), "Field type is not supported by the binary serializer");
+		}
+
+		// Consumes the value from the front of in
+		template <class T>
+		bool ReadValue(T& value, std::span<const std::byte>& in)
+		{
+			if constexpr (std::is_same_v<T, std::string>)
+			{
+				uint32_t size{};
+				if (!ReadValue(size, in) || in.size() < size)
+					return false;
+				value.assign(reinterpret_cast<const char*>(in.data()), size);
+				in = in.subspan(size);
+			}
+			else if constexpr (std::is_trivially_copyable_v<T>)
+			{
+				if (in.size() < sizeof(T))
+					return false;
+				std::memcpy(&value, in.data(), sizeof(T));
+				in = in.subspan(sizeof(T));
+			}
+			else
+				static_assert(!sizeof(T), "Field type is not supported by the binary serializer");
+			return true;
+		}
+	} // namespace Reflection
+
+	template <ReflectedComponent T>
+	rapidjson::Value SerializeComponent(const T& component, rapidjson::Document::AllocatorType& allocator)
+	{
+		rapidjson::Value out{rapidjson::kObjectType};
+		ForEachField(component, [&](std::string_view name, const auto& field) {
+			rapidjson::Value value{};
+			Reflection::SerializeValue(field, value, allocator);
+			out.AddMember(rapidjson::StringRef(name.data(), static_cast<rapidjson::SizeType>(name.size())), value, allocator);
+		});
+		return out;
+	}
+
+	// Fields missing from the json keep their default values, so old world files stay loadable when components grow
+	template <ReflectedComponent T>
+	bool DeserializeComponent(T& component, const rapidjson::Value& in)
+	{
+		if (!in.IsObject())
+			return false;
+
+		bool result{true};
+		ForEachField(component, [&](std::string_view name, auto& field) {
+			const auto& member = in.FindMember(rapidjson::StringRef(name.data(), static_cast<rapidjson::SizeType>(name.size())));
+			if (member != in.MemberEnd())
+				result &= Reflection::DeserializeValue(field, member->value);
+		});
+		return result;
+	}
+
+	// Fields are written in reflection order without names, cookers hash the component layout into their cache key
+	template <ReflectedComponent T>
+	void WriteComponent(const T& component, std::vector<std::byte>& out)
+	{
+		ForEachField(component, [&](std::string_view, const auto& field) { Reflection::WriteValue(field, out); });
+	}
+
+	template <ReflectedComponent T>
+	bool ReadComponent(T& component, std::span<const std::byte>& in)
+	{
+		bool result{true};
+		ForEachField(component, [&](std::string_view, auto& field) { result = result && Reflection::ReadValue(field, in); });
+		return result;
+	}
+
+	// Names, types and sizes of the component fields, changes whenever the binary layout does
+	template <ReflectedComponent T>
+	std::string GetComponentLayout()
+	{
+		std::string layout{GetComponentName<T>()};
+		ForEachField(T{}, [&](std::string_view name, const auto& field) {
+			layout += ':';
+			layout += name;
+			layout += '/';
+			layout += std::to_string(sizeof(field));
+		});
+		return layout;
+	}
+} // namespace oe
@@ -5,7 +5,7 @@
 
 #pragma once
 
-#include "Oneiro/Common/World/Components/IBaseComponent.hpp"
+#include "Oneiro/Common/World/Components/Reflection.hpp"
 
 #define GLM_ENABLE_EXPERIMENTAL
 #include "glm/gtc/matrix_transform.hpp"
@@ -13,9 +13,8 @@
 
 namespace oe
 {
-	class TransformComponent : public IBaseComponent
+	struct TransformComponent
 	{
-	public:
 		glm::vec3 position{};
 		glm::vec3 scale{1.0f};
 		glm::vec3 rotation{};
@@ -25,8 +24,25 @@ namespace oe
 			return glm::translate(glm::mat4(1.0f), position) * glm::scale(glm::mat4(1.0f), scale) * glm::toMat4(glm::quat(rotation));
 		}
 
-		void Serialize() override {}
+		static glm::mat4 Interpolate(const TransformComponent& previous, const TransformComponent& current, float alpha)
+		{
+			const auto position = glm::mix(previous.position, current.position, alpha);
+			const auto scale = glm::mix(previous.scale, current.scale, alpha);
+			const auto rotation = glm::slerp(glm::quat(previous.rotation), glm::quat(current.rotation), alpha);
+			return glm::translate(glm::mat4(1.0f), position) * glm::scale(glm::mat4(1.0f), scale) * glm::toMat4(rotation);
+		}
+	};
 
-		void Deserialize() override {}
+	// Transform of the previous fixed simulation step, rendering interpolates from it to the current TransformComponent
+	struct PreviousTransformComponent : TransformComponent
+	{
 	};
-} // namespace oe
\ No newline at end of file
+
+	OE_REFLECT_COMPONENT(TransformComponent,
+						 OE_COMPONENT_FIELD(TransformComponent, position, "Position"),
+						 OE_COMPONENT_FIELD(TransformComponent, scale, "Scale", .resetValue = 1.0f),
+						 OE_COMPONENT_FIELD(TransformComponent, rotation, "Rotation", .isAngle = true))
+
+	static_assert(std::is_trivially_copyable_v<TransformComponent> && std::is_standard_layout_v<TransformComponent>);
+	static_assert(std::is_trivially_copyable_v<PreviousTransformComponent>);
+} // namespace oe
@@ -8,9 +8,15 @@
 #include "Oneiro/Common/Common.hpp"
 #include "Oneiro/Common/EngineApi.hpp"
 #include "Oneiro/Common/FileSystem/FileSystem.hpp"
+#include "Oneiro/Common/JobManager.hpp"
+#include "Oneiro/Common/StringId.hpp"
 #include "Oneiro/Common/World/Components/Components.hpp"
 
+#include "flecs.h"
+#include "flecs/addons/cpp/flecs.hpp"
 #include "nameof.hpp"
+#include "rapidjson/stringbuffer.h"
+#include "rapidjson/writer.h"
 
 namespace oe
 {
@@ -23,6 +29,7 @@ namespace oe
 
 		Entity(flecs::entity handle, World* world) : m_Handle(handle), m_World(world)
 		{
+			// PreviousTransformComponent is added by the next StoreInterpolationState, from the transform the entity has then
 			if (IsValid())
 				GetOrAddComponent<TransformComponent>();
 		}
@@ -94,6 +101,43 @@ namespace oe
 				return ForceAddComponent<T>(args...);
 		}
 
+		template <class T>
+		void SetComponent(const T& value)
+		{
+			if (!IsValid())
+			{
+				OE_CORE_WARN("Invalid entity in function {}", NAMEOF(SetComponent<T>(value)).c_str());
+				return;
+			}
+
+			m_Handle.set<T>(value);
+		}
+
+		// Changes made through a pointer from GetComponent are invisible to change trackers and OnSet observers until
+		// the component is marked as modified. PatchComponent does both in one call.
+		template <class T>
+		void MarkModified()
+		{
+			if (!IsValid())
+			{
+				OE_CORE_WARN("Invalid entity in function {}", NAMEOF(MarkModified<T>()).c_str());
+				return;
+			}
+
+			m_Handle.modified<T>();
+		}
+
+		template <class T, class Func>
+		void PatchComponent(Func&& func)
+		{
+			auto* component = GetOrAddComponent<T>();
+			if (!component)
+				return;
+
+			func(*component);
+			m_Handle.modified<T>();
+		}
+
 		template <class T>
 		void RemoveComponent()
 		{
@@ -108,6 +152,28 @@ namespace oe
 			m_Handle.remove<T>();
 		}
 
+		// A disabled component stays on the entity, but queries and systems that use it skip the entity
+		template <class T>
+		void SetComponentActive(bool value)
+		{
+			if (!IsValid())
+			{
+				OE_CORE_WARN("Invalid entity in function {}", NAMEOF(SetComponentActive<T>(value)).c_str());
+				return;
+			}
+
+			if (value)
+				m_Handle.enable<T>();
+			else
+				m_Handle.disable<T>();
+		}
+
+		template <class T>
+		[[nodiscard]] bool IsComponentActive() const
+		{
+			return IsValid() && m_Handle.enabled<T>();
+		}
+
 		Entity ForceCreateChild(const std::string& name)
 		{
 			return {m_Handle, nullptr};
@@ -147,6 +213,26 @@ namespace oe
 			return IsValid();
 		}
 
+		// Inactive entities carry the flecs::Disabled tag, so every system and query skips them without a per-component flag
+		void SetActive(bool value)
+		{
+			if (!IsValid())
+			{
+				OE_CORE_WARN("Invalid entity in function {}", NAMEOF(SetActive(value)).c_str());
+				return;
+			}
+
+			if (value)
+				m_Handle.enable();
+			else
+				m_Handle.disable();
+		}
+
+		[[nodiscard]] bool IsActive() const
+		{
+			return IsValid() && !m_Handle.has(flecs::Disabled);
+		}
+
 		std::string GetName()
 		{
 			if (!IsValid())
@@ -155,31 +241,226 @@ namespace oe
 			return m_Handle.name().c_str();
 		}
 
+		// Goes through the world, so lookups by the new name keep working
+		void SetName(const std::string& name);
+
 	private:
 		friend class World;
 		flecs::entity m_Handle{};
 		World* m_World{};
 	};
 
+	// Visits only entities in tables whose Components changed since the previous Each call. Unchanged tables are
+	// skipped by comparing flecs table versions, so a static scene costs a single check per frame.
+	template <class... Components>
+	class ChangeTracker
+	{
+	public:
+		ChangeTracker() = default;
+
+		explicit ChangeTracker(flecs::query<const Components...> query) : m_Query(query) {}
+
+		[[nodiscard]] bool IsChanged()
+		{
+			return m_Query.changed();
+		}
+
+		template <class Func>
+		size_t Each(Func&& func)
+		{
+			if (!m_Query.changed())
+				return 0;
+
+			size_t visited{};
+			m_Query.iter([&](flecs::iter& it, const Components*... components) {
+				if (!it.changed())
+				{
+					it.skip();
+					return;
+				}
+
+				for (auto i : it)
+					func(it.entity(i), components[i]...);
+				visited += it.count();
+			});
+			return visited;
+		}
+
+	private:
+		flecs::query<const Components...> m_Query{};
+	};
+
 	class World
 	{
 	public:
+		World()
+		{
+			// Components are registered up front, so worlds can later be ticked from JobManager workers without lazily
+			// registering component ids concurrently. Worlds may be created on workers by the asset streamer, and the
+			// first registration of a type assigns its global id, hence the lock. It covers the flecs builtins that the
+			// world registers itself as well.
+			std::lock_guard lock(GetRegistrationMutex());
+			m_ECS = CreateRef<flecs::world>();
+			RegisterComponents(*m_ECS, static_cast<SerializableComponents*>(nullptr));
+			m_ECS->component<PreviousTransformComponent>();
+			for (const auto& registration : GetComponentRegistrations())
+				registration(*m_ECS);
+
+			m_InterpolationQuery = m_ECS->query<const TransformComponent, PreviousTransformComponent>();
+			m_NewInterpolationQuery = m_ECS->query_builder<const TransformComponent>().without<PreviousTransformComponent>().build();
+			// Read only, rendering must not flag the tables as changed for change trackers and snapshots
+			m_RenderQuery = m_ECS->query<const TransformComponent, const PreviousTransformComponent>();
+			m_Root = m_ECS->entity("Root");
+		}
+
+		World(const World&) = delete;
+		World& operator=(const World&) = delete;
+
+		// Registers the component in every world created from now on, see the constructor. Game and module components
+		// have to be registered before the first world that uses them is created.
+		template <class T>
+		static void RegisterComponent()
+		{
+			std::lock_guard lock(GetRegistrationMutex());
+			GetComponentRegistrations().emplace_back([](flecs::world& ecs) { ecs.component<T>(); });
+		}
+
+		// Parsed straight from the mapping, large worlds are not copied into memory first
 		bool Load(const FileSystem::Path& path)
+		{
+			const auto file = FileSystem::Map(path);
+			return Load(path, file.GetString());
+		}
+
+		// For data that was already read, e.g. by the asset streamer
+		bool Load(const FileSystem::Path& path, std::string_view data)
 		{
 			m_Path = path;
-			m_Root = EngineApi::GetECS()->entity("Root");
-			//			const auto node = YAML::Load(FileSystem::Read(path));
-			//			const auto& entities = node["Entities"];
-			//			for (const auto& entityNode : entities)
-			//			{
-			//				auto entity = CreateEntity(entityNode["Name"].as<std::string>());
-			//
-			//				entity.GetOrAddComponent<TransformComponent>()->Serialize(entityNode["TransformComponent"]);
-			//			}
+			m_SourcePath = path;
+			return LoadFromData(data);
+		}
+
+		// An empty data string is a new world without entities
+		bool LoadFromData(std::string_view data)
+		{
+			if (data.empty())
+				return true;
+
+			rapidjson::Document document{};
+			document.Parse(data.data(), data.size());
+			if (document.HasParseError() || !document.IsObject())
+			{
+				OE_CORE_ERROR("Failed to parse world '{}'!", m_Path.string());
+				return false;
+			}
+
+			const auto& entities = document.FindMember("Entities");
+			if (entities == document.MemberEnd() || !entities->value.IsArray())
+				return true;
+
+			for (const auto& entityValue : entities->value.GetArray())
+			{
+				const auto& name = entityValue.FindMember("Name");
+				if (name == entityValue.MemberEnd() || !name->value.IsString())
+					continue;
+
+				auto entity = CreateEntity(name->value.GetString());
+				DeserializeComponents(entity, entityValue, static_cast<SerializableComponents*>(nullptr));
+
+				const auto& active = entityValue.FindMember("Active");
+				if (active != entityValue.MemberEnd() && active->value.IsBool())
+					entity.SetActive(active->value.GetBool());
+			}
+
+			return true;
+		}
+
+		// For cooked data, see Cook. Save writes the json source to sourcePath, worlds without one are not saved.
+		bool LoadCooked(const FileSystem::Path& path, std::span<const std::byte> data, const FileSystem::Path& sourcePath = {})
+		{
+			m_Path = path;
+			m_SourcePath = sourcePath;
+			return LoadFromCooked(data);
+		}
+
+		bool LoadFromCooked(std::span<const std::byte> data)
+		{
+			if (data.empty())
+				return true;
+
+			uint32_t entitiesCount{};
+			if (!Reflection::ReadValue(entitiesCount, data))
+				return false;
+
+			for (uint32_t i{}; i < entitiesCount; ++i)
+			{
+				std::string name{};
+				bool isActive{};
+				uint32_t componentsMask{};
+				if (!Reflection::ReadValue(name, data) || !Reflection::ReadValue(isActive, data) ||
+					!Reflection::ReadValue(componentsMask, data))
+				{
+					OE_CORE_ERROR("Cooked world '{}' is truncated!", m_Path.string());
+					return false;
+				}
+
+				auto entity = CreateEntity(name);
+				if (!ReadCookedComponents(entity, componentsMask, data, static_cast<SerializableComponents*>(nullptr)))
+				{
+					OE_CORE_ERROR("Cooked world '{}' has invalid components of entity '{}'!", m_Path.string(), name);
+					return false;
+				}
+				entity.SetActive(isActive);
+			}
+
+			return true;
+		}
+
+		// Converts the json world format to the binary format read by LoadFromCooked, without creating a world.
+		// Entities keep the json order, so the output only depends on the input.
+		static bool Cook(std::string_view data, std::vector<std::byte>& cooked)
+		{
+			cooked.clear();
+			if (data.empty())
+				return true;
+
+			rapidjson::Document document{};
+			document.Parse(data.data(), data.size());
+			if (document.HasParseError() || !document.IsObject())
+				return false;
+
+			uint32_t entitiesCount{};
+			Reflection::WriteValue(entitiesCount, cooked);
+
+			const auto& entities = document.FindMember("Entities");
+			if (entities == document.MemberEnd() || !entities->value.IsArray())
+				return true;
+
+			for (const auto& entityValue : entities->value.GetArray())
+			{
+				const auto& name = entityValue.FindMember("Name");
+				if (name == entityValue.MemberEnd() || !name->value.IsString())
+					continue;
+
+				const auto& active = entityValue.FindMember("Active");
+				const auto isActive = active == entityValue.MemberEnd() || !active->value.IsBool() || active->value.GetBool();
 
+				Reflection::WriteValue(std::string{name->value.GetString(), name->value.GetStringLength()}, cooked);
+				Reflection::WriteValue(isActive, cooked);
+				WriteCookedComponents(entityValue, cooked, static_cast<SerializableComponents*>(nullptr));
+				++entitiesCount;
+			}
+
+			std::memcpy(cooked.data(), &entitiesCount, sizeof(entitiesCount));
 			return true;
 		}
 
+		// Changes whenever the cooked format of the serializable components does
+		static std::string GetCookedLayout()
+		{
+			return GetCookedLayout(static_cast<SerializableComponents*>(nullptr));
+		}
+
 		bool UnLoad()
 		{
 			return Save();
@@ -187,41 +468,73 @@ namespace oe
 
 		bool Save()
 		{
-			//			m_Root.children([this, &out](flecs::entity children) {
-			//				Entity entity{children, this};
-			//				if (entity)
-			//				{
-			//				}
-			//			});
-			//			FileSystem::Write(m_Path, reinterpret_cast<const uint8_t*>(out.c_str()), out.size());
+			// Never written to m_Path, that may be a cooked file
+			if (m_SourcePath.empty())
+				return true;
+
+			rapidjson::Document document{};
+			document.SetObject();
+			auto& allocator = document.GetAllocator();
+
+			rapidjson::Value entities{rapidjson::kArrayType};
+			m_Root.children([&](flecs::entity child) {
+				rapidjson::Value entityValue{rapidjson::kObjectType};
+				entityValue.AddMember("Name", rapidjson::Value(child.name().c_str(), allocator), allocator);
+				entityValue.AddMember("Active", !child.has(flecs::Disabled), allocator);
+				SerializeComponents(child, entityValue, allocator, static_cast<SerializableComponents*>(nullptr));
+				entities.PushBack(entityValue, allocator);
+			});
+			document.AddMember("Entities", entities, allocator);
+
+			rapidjson::StringBuffer writerBuffer;
+			rapidjson::Writer<rapidjson::StringBuffer> writer(writerBuffer);
+			document.Accept(writer);
+			FileSystem::Write(m_SourcePath, reinterpret_cast<const uint8_t*>(writerBuffer.GetString()), writerBuffer.GetSize());
 
 			return true;
 		}
 
 		Entity CreateEntity(const std::string& name)
 		{
-			return {EngineApi::GetECS()->entity(name.c_str()).child_of(m_Root), this};
+			auto entity = m_ECS->entity(name.c_str()).child_of(m_Root);
+			m_Entities[StringId{name}] = entity;
+			return {entity, this};
 		}
 
-		Entity GetEntity(const std::string& name)
+		// Root entities are indexed by the StringId of their name, "Player"_sid lookups hash nothing at runtime
+		Entity GetEntity(StringId name)
 		{
-			return {m_Root.lookup(name.c_str()), this};
+			const auto& entity = m_Entities.find(name);
+			if (entity == m_Entities.end())
+				return {};
+
+			if (!entity->second.is_alive())
+			{
+				m_Entities.erase(entity);
+				return {};
+			}
+			return {entity->second, this};
 		}
 
-		void DestroyEntity(const std::string& name)
+		void DestroyEntity(StringId name)
 		{
 			auto entity = GetEntity(name);
 			if (entity)
-				EngineApi::GetECS()->delete_with(entity.m_Handle);
+				DestroyEntity(entity);
 		}
 
 		void DestroyEntity(const Entity& entity)
 		{
-			if (entity)
-				EngineApi::GetECS()->delete_with(entity.m_Handle);
+			if (!entity)
+				return;
+
+			const auto& indexed = m_Entities.find(StringId{entity.m_Handle.name().c_str()});
+			if (indexed != m_Entities.end() && indexed->second == entity.m_Handle)
+				m_Entities.erase(indexed);
+			m_ECS->delete_with(entity.m_Handle);
 		}
 
-		bool HasEntity(const std::string& name)
+		bool HasEntity(StringId name)
 		{
 			return GetEntity(name);
 		}
@@ -235,10 +548,23 @@ namespace oe
 				return CreateEntity(name);
 		}
 
+		void RenameEntity(Entity& entity, const std::string& name)
+		{
+			if (!entity)
+				return;
+
+			const auto& indexed = m_Entities.find(StringId{entity.m_Handle.name().c_str()});
+			if (indexed != m_Entities.end() && indexed->second == entity.m_Handle)
+				m_Entities.erase(indexed);
+			entity.m_Handle.set_name(name.c_str());
+			if (entity.m_Handle.parent() == m_Root)
+				m_Entities[StringId{name}] = entity.m_Handle;
+		}
+
 		std::vector<Entity> GetEntities()
 		{
 			std::vector<Entity> result{};
-			EngineApi::GetECS()->each([&](flecs::entity flecsEntity) {
+			m_ECS->each([&](flecs::entity flecsEntity) {
 				result.emplace_back(flecsEntity, this);
 			});
 			return result;
@@ -246,48 +572,307 @@ namespace oe
 
 		bool UpdateRuntime(float deltaTime)
 		{
-			return EngineApi::GetECS()->progress(deltaTime);
+			return m_ECS->progress(deltaTime);
+		}
+
+		// Called before every fixed simulation step so rendering can interpolate between the previous and the current step
+		void StoreInterpolationState()
+		{
+			m_InterpolationQuery.each([](const TransformComponent& current, PreviousTransformComponent& previous) {
+				static_cast<TransformComponent&>(previous) = current;
+			});
+
+			// Entities spawned or loaded since the last step start from where they are, not from the origin. Until then
+			// GetInterpolatedTransform returns their current transform.
+			m_ECS->defer_begin();
+			m_NewInterpolationQuery.each([](flecs::entity entity, const TransformComponent& current) {
+				entity.set<PreviousTransformComponent>({current});
+			});
+			m_ECS->defer_end();
+		}
+
+		// Transforms of every active entity for rendering at display rate, alpha is Engine::GetInterpolationAlpha()
+		void GetInterpolatedTransforms(float alpha, std::vector<glm::mat4>& transforms)
+		{
+			m_RenderQuery.each([&](const TransformComponent& current, const PreviousTransformComponent& previous) {
+				transforms.emplace_back(TransformComponent::Interpolate(previous, current, alpha));
+			});
+			m_NewInterpolationQuery.each([&](const TransformComponent& current) { transforms.emplace_back(current.GetTransform()); });
+		}
+
+		glm::mat4 GetInterpolatedTransform(Entity& entity, float alpha)
+		{
+			const auto* current = entity.GetComponent<TransformComponent>();
+			if (!current)
+				return glm::mat4(1.0f);
+
+			const auto* previous = entity.GetComponent<PreviousTransformComponent>();
+			if (!previous)
+				return current->GetTransform();
+
+			return TransformComponent::Interpolate(*previous, *current, alpha);
+		}
+
+		template <class... Components>
+		ChangeTracker<Components...> CreateChangeTracker()
+		{
+			return ChangeTracker<Components...>{m_ECS->query<const Components...>()};
+		}
+
+		// Event is one of flecs::OnAdd, flecs::OnSet or flecs::OnRemove, func receives (flecs::entity, Components&...)
+		template <class... Components, class Func>
+		flecs::observer Observe(flecs::entity_t event, Func&& func)
+		{
+			return m_ECS->observer<Components...>().event(event).each(std::forward<Func>(func));
+		}
+
+		template <class... Components, class Func>
+		flecs::observer OnComponentsChanged(Func&& func)
+		{
+			return Observe<Components...>(flecs::OnSet, std::forward<Func>(func));
+		}
+
+		template <class... Components, class... Args>
+		flecs::system_builder<Components...> RegisterSystem(const std::string& name, const Args&... args)
+		{
+			return m_ECS->system<Components...>(name.c_str(), args...);
+		}
+
+		[[nodiscard]] flecs::world* GetECS() const noexcept
+		{
+			return m_ECS.get();
+		}
+
+		[[nodiscard]] const FileSystem::Path& GetPath() const noexcept
+		{
+			return m_Path;
+		}
+
+		[[nodiscard]] const FileSystem::Path& GetSourcePath() const noexcept
+		{
+			return m_SourcePath;
 		}
 
 	private:
+		template <class... Components>
+		static void SerializeComponents(flecs::entity entity, rapidjson::Value& out, rapidjson::Document::AllocatorType& allocator,
+										std::tuple<Components...>*)
+		{
+			(
+				[&] {
+					if (const auto* component = entity.get<Components>())
+					{
+						const auto name = GetComponentName<Components>();
+						out.AddMember(rapidjson::StringRef(name.data(), static_cast<rapidjson::SizeType>(name.size())),
+									  SerializeComponent(*component, allocator), allocator);
+					}
+				}(),
+				...);
+		}
+
+		template <class... Components>
+		static void DeserializeComponents(Entity& entity, const rapidjson::Value& in, std::tuple<Components...>*)
+		{
+			(
+				[&] {
+					const auto name = GetComponentName<Components>();
+					const auto& member = in.FindMember(rapidjson::StringRef(name.data(), static_cast<rapidjson::SizeType>(name.size())));
+					if (member == in.MemberEnd())
+						return;
+
+					Components component{};
+					if (!DeserializeComponent(component, member->value))
+						OE_CORE_WARN("Component '{}' of entity '{}' is partially invalid!", name, entity.GetName());
+					entity.SetComponent(component);
+				}(),
+				...);
+		}
+
+		template <class... Components>
+		static void WriteCookedComponents(const rapidjson::Value& in, std::vector<std::byte>& cooked, std::tuple<Components...>*)
+		{
+			static_assert(sizeof...(Components) <= 32, "Cooked worlds store the components of an entity in a 32 bit mask");
+
+			std::vector<const rapidjson::Value*> values{};
+			uint32_t componentsMask{};
+			(
+				[&] {
+					const auto name = GetComponentName<Components>();
+					const auto& member = in.FindMember(rapidjson::StringRef(name.data(), static_cast<rapidjson::SizeType>(name.size())));
+					const auto bit = static_cast<uint32_t>(values.size());
+					values.emplace_back(member != in.MemberEnd() ? &member->value : nullptr);
+					if (values.back())
+						componentsMask |= 1u << bit;
+				}(),
+				...);
+
+			Reflection::WriteValue(componentsMask, cooked);
+
+			size_t index{};
+			(
+				[&] {
+					if (const auto* value = values[index++])
+					{
+						Components component{};
+						if (!DeserializeComponent(component, *value))
+							OE_CORE_WARN("Component '{}' is partially invalid!", GetComponentName<Components>());
+						WriteComponent(component, cooked);
+					}
+				}(),
+				...);
+		}
+
+		template <class... Components>
+		static bool ReadCookedComponents(Entity& entity, uint32_t componentsMask, std::span<const std::byte>& data, std::tuple<Components...>*)
+		{
+			bool result{true};
+			uint32_t bit{};
+			(
+				[&] {
+					if (!result || !(componentsMask & (1u << bit++)))
+						return;
+
+					Components component{};
+					result = ReadComponent(component, data);
+					if (result)
+						entity.SetComponent(component);
+				}(),
+				...);
+			return result;
+		}
+
+		template <class... Components>
+		static std::string GetCookedLayout(std::tuple<Components...>*)
+		{
+			std::string layout{};
+			((layout += GetComponentLayout<Components>() + ';'), ...);
+			return layout;
+		}
+
+		template <class... Components>
+		static void RegisterComponents(flecs::world& ecs, std::tuple<Components...>*)
+		{
+			(ecs.component<Components>(), ...);
+		}
+
+		static std::mutex& GetRegistrationMutex()
+		{
+			static std::mutex mutex{};
+			return mutex;
+		}
+
+		static std::vector<void (*)(flecs::world&)>& GetComponentRegistrations()
+		{
+			static std::vector<void (*)(flecs::world&)> registrations{};
+			return registrations;
+		}
+
+		Ref<flecs::world> m_ECS{};
+		flecs::query<const TransformComponent, PreviousTransformComponent> m_InterpolationQuery{};
+		flecs::query<const TransformComponent> m_NewInterpolationQuery{};
+		flecs::query<const TransformComponent, const PreviousTransformComponent> m_RenderQuery{};
 		flecs::entity m_Root{};
+		std::unordered_map<StringId, flecs::entity> m_Entities{};
 		FileSystem::Path m_Path{};
+		FileSystem::Path m_SourcePath{};
 	};
 
+	inline void Entity::SetName(const std::string& name)
+	{
+		if (!IsValid())
+		{
+			OE_CORE_WARN("Invalid entity in function {}", NAMEOF(SetName(name)).c_str());
+			return;
+		}
+
+		m_World->RenameEntity(*this, name);
+	}
+
 	class WorldManager
 	{
 	public:
 		World* CreateWorld()
 		{
-			m_CurrentWorld = CreateRef<World>();
-			return m_CurrentWorld.get();
+			m_CurrentWorld = AddWorld(CreateRef<World>());
+			return m_CurrentWorld;
 		}
 
 		World* LoadWorld(const FileSystem::Path& path)
 		{
-			m_CurrentWorld = CreateRef<World>();
-			m_CurrentWorld->Load(path);
-			return m_CurrentWorld.get();
+			auto world = CreateRef<World>();
+			world->Load(path);
+			m_CurrentWorld = AddWorld(world);
+			return m_CurrentWorld;
+		}
+
+		World* AddWorld(const Ref<World>& world)
+		{
+			return m_Worlds.emplace_back(world).get();
 		}
 
 		void UnLoadWorld()
 		{
-			m_CurrentWorld->UnLoad();
-			m_CurrentWorld.reset();
+			UnLoadWorld(m_CurrentWorld);
+		}
+
+		void UnLoadWorld(World* world)
+		{
+			const auto& iter = std::find_if(m_Worlds.begin(), m_Worlds.end(), [world](const auto& item) {
+				return item.get() == world;
+			});
+			if (iter == m_Worlds.end())
+				return;
+
+			(*iter)->UnLoad();
+			m_Worlds.erase(iter);
+			if (m_CurrentWorld == world)
+				m_CurrentWorld = nullptr;
+		}
+
+		void SetWorld(World* world)
+		{
+			m_CurrentWorld = world;
 		}
 
 		World* GetWorld() const
 		{
-			return m_CurrentWorld.get();
+			return m_CurrentWorld;
+		}
+
+		const std::vector<Ref<World>>& GetWorlds() const
+		{
+			return m_Worlds;
+		}
+
+		// Every world owns its own flecs::world, so independent worlds are ticked in parallel on JobManager workers without
+		// sharing any ECS state. The caller ticks worlds itself, so a pool full of other jobs never stalls it.
+		bool UpdateWorlds(float deltaTime)
+		{
+			if (m_Worlds.size() <= 1)
+				return m_Worlds.empty() || m_Worlds.front()->UpdateRuntime(deltaTime);
+
+			std::atomic<bool> result{true};
+			JobManager::ParallelFor(m_Worlds.size(), [this, deltaTime, &result](size_t index) {
+				if (!m_Worlds[index]->UpdateRuntime(deltaTime))
+					result.store(false);
+			});
+			return result.load();
+		}
+
+		void StoreInterpolationState()
+		{
+			for (const auto& world : m_Worlds)
+				world->StoreInterpolationState();
 		}
 
 		template <class... Components, class... Args>
 		flecs::system_builder<Components...> RegisterSystem(const std::string& name, const Args&... args)
 		{
-			return EngineApi::GetECS()->system<Components...>(name.c_str(), args...);
+			return m_CurrentWorld->RegisterSystem<Components...>(name, args...);
 		}
 
 	private:
-		Ref<World> m_CurrentWorld{};
+		std::vector<Ref<World>> m_Worlds{};
+		World* m_CurrentWorld{};
 	};
 } // namespace oe
\ No newline at end of file
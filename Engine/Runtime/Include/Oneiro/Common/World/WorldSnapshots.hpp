@@ -0,0 +1,249 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include "Oneiro/Common/World/World.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <vector>
+
+namespace oe
+{
+	// Ring of the last N simulation frames of Components for rollback and deterministic replays.
+	// Capture copies only the tables whose Components changed since the previous capture. Unchanged tables share the page
+	// of the previous frame (copy-on-write), and pages of overwritten frames are recycled, so steady state capturing does
+	// not allocate. Restore is a memcpy per table column as long as the table still holds the same entities, otherwise
+	// the affected entities are restored one by one. Entity lifetime itself is not part of a snapshot.
+	// Restoring a frame rewinds the ring to it: the frames after it are dropped and the next capture follows it.
+	template <PlainComponent... Components>
+	class WorldSnapshots
+	{
+	public:
+		WorldSnapshots(World* world, size_t capacity)
+			: m_World(world), m_CaptureQuery(world->GetECS()->query<const Components...>()),
+			  m_RestoreQuery(world->GetECS()->query<Components...>()), m_Frames(std::max<size_t>(capacity, 1))
+		{
+		}
+
+		WorldSnapshots(const WorldSnapshots&) = delete;
+		WorldSnapshots& operator=(const WorldSnapshots&) = delete;
+
+		// Returns the number of the captured frame
+		uint64_t Capture()
+		{
+			// With a single slot the previous frame is the one being overwritten, so there is nothing to share. Right after
+			// a restore change detection still refers to the dropped frames, so everything is copied.
+			const Frame* previous =
+				m_Frames.size() > 1 && !m_IsRewound && HasFrame(m_NextFrame - 1) ? &GetFrame(m_NextFrame - 1) : nullptr;
+			m_IsRewound = false;
+
+			auto& frame = GetFrame(m_NextFrame);
+			ReleaseFrame(frame);
+			frame.number = m_NextFrame;
+
+			m_CaptureQuery.iter([&](flecs::iter& it, const Components*... components) {
+				const auto* table = it.c_ptr()->table;
+				const auto count = static_cast<size_t>(it.count());
+
+				if (previous && !it.changed())
+				{
+					if (const auto* shared = FindTable(*previous, table); shared && shared->page->entities.size() == count)
+					{
+						frame.tables.push_back(*shared);
+						it.skip();
+						return;
+					}
+				}
+
+				auto page = AcquirePage();
+				page->entities.assign(it.c_ptr()->entities, it.c_ptr()->entities + count);
+
+				size_t column{};
+				(CopyColumn(page->columns[column++], components, count), ...);
+
+				frame.tables.push_back({table, std::move(page)});
+			});
+
+			std::sort(frame.tables.begin(), frame.tables.end(), [](const TableSnapshot& left, const TableSnapshot& right) {
+				return std::less<>{}(left.table, right.table);
+			});
+
+			return m_NextFrame++;
+		}
+
+		bool Restore(uint64_t number)
+		{
+			if (!HasFrame(number))
+			{
+				OE_CORE_WARN("Snapshot of frame {} is not available!", number);
+				return false;
+			}
+
+			const auto& frame = GetFrame(number);
+			m_Restored.assign(frame.tables.size(), false);
+
+			m_RestoreQuery.iter([&](flecs::iter& it, Components*... components) {
+				// Skipped tables are not written, so they must not be marked as changed
+				const auto* snapshot = FindTable(frame, it.c_ptr()->table);
+				if (!snapshot)
+				{
+					it.skip();
+					return;
+				}
+
+				const auto count = static_cast<size_t>(it.count());
+				const auto& page = *snapshot->page;
+				if (page.entities.size() != count ||
+					std::memcmp(page.entities.data(), it.c_ptr()->entities, count * sizeof(ecs_entity_t)) != 0)
+				{
+					it.skip();
+					return;
+				}
+
+				size_t column{};
+				(RestoreColumn(components, page.columns[column++], count), ...);
+				m_Restored[static_cast<size_t>(snapshot - frame.tables.data())] = true;
+			});
+
+			// Entities moved to other tables since the capture can't be restored in bulk
+			for (size_t i{}; i < frame.tables.size(); ++i)
+			{
+				if (!m_Restored[i])
+					RestoreEntities(*frame.tables[i].page);
+			}
+
+			// Drop the frames after the restored one, the next capture follows it
+			for (auto next = number + 1; next < m_NextFrame && next - number < m_Frames.size(); ++next)
+				ReleaseFrame(GetFrame(next));
+			m_NextFrame = number + 1;
+			m_IsRewound = true;
+
+			return true;
+		}
+
+		// Slots are shared with the dropped frames after a restore, so the slot has to still hold the frame
+		[[nodiscard]] bool HasFrame(uint64_t number) const noexcept
+		{
+			return number < m_NextFrame && m_NextFrame - number <= m_Frames.size() && GetFrame(number).number == number;
+		}
+
+		[[nodiscard]] uint64_t GetLatestFrame() const noexcept
+		{
+			return m_NextFrame - 1;
+		}
+
+		[[nodiscard]] size_t GetCapacity() const noexcept
+		{
+			return m_Frames.size();
+		}
+
+	private:
+		struct TablePage
+		{
+			std::vector<ecs_entity_t> entities{};
+			std::array<std::vector<std::byte>, sizeof...(Components)> columns{};
+		};
+
+		struct TableSnapshot
+		{
+			const ecs_table_t* table{};
+			Ref<TablePage> page{};
+		};
+
+		struct Frame
+		{
+			uint64_t number{};
+			std::vector<TableSnapshot> tables{};
+		};
+
+		Frame& GetFrame(uint64_t number) noexcept
+		{
+			return m_Frames[number % m_Frames.size()];
+		}
+
+		const Frame& GetFrame(uint64_t number) const noexcept
+		{
+			return m_Frames[number % m_Frames.size()];
+		}
+
+		static const TableSnapshot* FindTable(const Frame& frame, const ecs_table_t* table) noexcept
+		{
+			const auto& iter = std::lower_bound(frame.tables.begin(), frame.tables.end(), table, [](const TableSnapshot& item, const ecs_table_t* value) {
+				return std::less<>{}(item.table, value);
+			});
+			if (iter != frame.tables.end() && iter->table == table)
+				return &*iter;
+			return nullptr;
+		}
+
+		Ref<TablePage> AcquirePage()
+		{
+			if (m_FreePages.empty())
+				return CreateRef<TablePage>();
+
+			auto page = std::move(m_FreePages.back());
+			m_FreePages.pop_back();
+			return page;
+		}
+
+		// Pages no longer shared with a newer frame go back to the pool together with their buffers
+		void ReleaseFrame(Frame& frame)
+		{
+			for (auto& snapshot : frame.tables)
+			{
+				if (snapshot.page.use_count() == 1)
+					m_FreePages.emplace_back(std::move(snapshot.page));
+			}
+			frame.tables.clear();
+		}
+
+		template <class T>
+		static void CopyColumn(std::vector<std::byte>& destination, const T* source, size_t count)
+		{
+			destination.resize(count * sizeof(T));
+			std::memcpy(destination.data(), source, destination.size());
+		}
+
+		template <class T>
+		static void RestoreColumn(T* destination, const std::vector<std::byte>& source, size_t count)
+		{
+			std::memcpy(destination, source.data(), count * sizeof(T));
+		}
+
+		void RestoreEntities(const TablePage& page)
+		{
+			auto* ecs = m_World->GetECS();
+			for (size_t row{}; row < page.entities.size(); ++row)
+			{
+				const flecs::entity entity{*ecs, page.entities[row]};
+				if (!entity.is_alive())
+					continue;
+
+				size_t column{};
+				(RestoreComponent<Components>(entity, page.columns[column++], row), ...);
+			}
+		}
+
+		template <class T>
+		static void RestoreComponent(flecs::entity entity, const std::vector<std::byte>& column, size_t row)
+		{
+			T component;
+			std::memcpy(&component, column.data() + row * sizeof(T), sizeof(T));
+			entity.set<T>(component);
+		}
+
+		World* m_World{};
+		flecs::query<const Components...> m_CaptureQuery{};
+		flecs::query<Components...> m_RestoreQuery{};
+		std::vector<Frame> m_Frames{};
+		std::vector<Ref<TablePage>> m_FreePages{};
+		std::vector<bool> m_Restored{};
+		uint64_t m_NextFrame{};
+		bool m_IsRewound{};
+	};
+} // namespace oe
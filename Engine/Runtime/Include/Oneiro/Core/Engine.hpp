@@ -14,13 +14,18 @@ namespace oe
 	class Engine
 	{
 	public:
-		void PreInit(IApplication* application);
+		void PreInit(IApplication* application, int argc = 0, char** argv = nullptr);
 		void Init();
 		void Run();
 		void Shutdown();
 
 		static float GetDeltaTime() noexcept;
+		static float GetFixedDeltaTime() noexcept;
+		static float GetInterpolationAlpha() noexcept;
 		static bool IsRuntime() noexcept;
+		static bool IsHeadless() noexcept;
+
+		static void RequestShutdown() noexcept;
 
 		EngineApi* GetApi()
 		{
@@ -28,8 +33,24 @@ namespace oe
 		}
 
 	private:
+		void RunHeadless();
+		void UpdateSimulation(float deltaTime);
+
+		static void OnShutdownSignal(int signal);
+
 		inline static float m_DeltaTime{};
+		inline static float m_FixedDeltaTime{};
+		inline static float m_InterpolationAlpha{1.0f};
 		inline static bool m_IsRuntime{};
+		inline static bool m_IsHeadless{};
+		inline static std::atomic<bool> m_IsShutdownRequested{};
+
+		float m_Accumulator{};
+
+		std::string m_CookSource{};
+		std::string m_CookOutput{};
+		std::string m_PreloadPath{};
+		std::string m_PreloadRecordPath{};
 
 		IModule* m_WMModule{};
 		IModule* m_RendererModule{};
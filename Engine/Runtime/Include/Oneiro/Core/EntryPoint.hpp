@@ -8,13 +8,13 @@
 #include "Oneiro/Core/Engine.hpp"
 
 #define OE_MAIN(applicationFunc)                                 \
-	int main(int /*argc*/, char** /*argv*/)                      \
+	int main(int argc, char** argv)                              \
 	{                                                            \
 		auto application = applicationFunc();                    \
 		auto engine = std::make_unique<oe::Engine>();            \
 		try                                                      \
 		{                                                        \
-			engine->PreInit(application.get());                  \
+			engine->PreInit(application.get(), argc, argv);      \
 			oe::EngineApi::Initialize(engine->GetApi());         \
 			engine->Init();                                      \
 			engine->Run();                                       \
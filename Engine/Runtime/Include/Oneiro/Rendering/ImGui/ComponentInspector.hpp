@@ -0,0 +1,151 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include "Oneiro/Common/World/Components/Reflection.hpp"
+
+#include "imgui.h"
+#include "imgui_internal.h"
+#include "imgui_stdlib.h"
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <type_traits>
+
+namespace oe
+{
+	namespace Inspector
+	{
+		template <class T>
+		constexpr ImGuiDataType GetDataType() noexcept
+		{
+			if constexpr (std::is_same_v<T, float>)
+				return ImGuiDataType_Float;
+			else if constexpr (std::is_same_v<T, double>)
+				return ImGuiDataType_Double;
+			else if constexpr (std::is_signed_v<T>)
+			{
+				if constexpr (sizeof(T) == 1)
+					return ImGuiDataType_S8;
+				else if constexpr (sizeof(T) == 2)
+					return ImGuiDataType_S16;
+				else if constexpr (sizeof(T) == 4)
+					return ImGuiDataType_S32;
+				else
+					return ImGuiDataType_S64;
+			}
+			else
+			{
+				if constexpr (sizeof(T) == 1)
+					return ImGuiDataType_U8;
+				else if constexpr (sizeof(T) == 2)
+					return ImGuiDataType_U16;
+				else if constexpr (sizeof(T) == 4)
+					return ImGuiDataType_U32;
+				else
+					return ImGuiDataType_U64;
+			}
+		}
+
+		template <class T>
+		concept FloatingVector = requires { T::length(); } && std::is_floating_point_v<typename T::value_type>;
+
+		// Label column and one colored reset button in front of the drag of every axis, the button sets resetValue
+		template <class T>
+		bool DrawVectorControl(const char* label, T& value, float resetValue, float columnWidth = 80.0f)
+		{
+			using ValueType = typename T::value_type;
+			static constexpr std::array<const char*, 4> axes{"X", "Y", "Z", "W"};
+			static constexpr std::array<ImVec4, 4> colors{ImVec4{0.8f, 0.1f, 0.15f, 1.0f}, ImVec4{0.2f, 0.7f, 0.2f, 1.0f},
+														  ImVec4{0.1f, 0.25f, 0.8f, 1.0f}, ImVec4{0.5f, 0.5f, 0.5f, 1.0f}};
+
+			const auto lineHeight = GImGui->Font->FontSize + GImGui->Style.FramePadding.y * 2.0f;
+			const ImVec2 buttonSize{lineHeight + 3.0f, lineHeight};
+			bool isChanged{};
+
+			ImGui::PushID(label);
+			ImGui::Columns(2);
+			ImGui::SetColumnWidth(0, columnWidth);
+			ImGui::Text("%s", label);
+			ImGui::NextColumn();
+
+			ImGui::PushMultiItemsWidths(T::length(), ImGui::CalcItemWidth());
+			ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2{0, 0});
+			for (glm::length_t i{}; i < T::length(); ++i)
+			{
+				const auto& color = colors[static_cast<size_t>(i)];
+				ImGui::PushStyleColor(ImGuiCol_Button, color);
+				ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4{color.x + 0.1f, color.y + 0.1f, color.z + 0.1f, 1.0f});
+				ImGui::PushStyleColor(ImGuiCol_ButtonActive, color);
+				ImGui::PushFont(ImGui::GetIO().Fonts->Fonts[0]);
+				if (ImGui::Button(axes[static_cast<size_t>(i)], buttonSize))
+				{
+					value[i] = static_cast<ValueType>(resetValue);
+					isChanged = true;
+				}
+				ImGui::PopFont();
+				ImGui::PopStyleColor(3);
+
+				ImGui::SameLine();
+				const auto id = std::string{"##"} + axes[static_cast<size_t>(i)];
+				isChanged |= ImGui::DragScalar(id.c_str(), GetDataType<ValueType>(), &value[i],
+											   std::is_floating_point_v<ValueType> ? 0.1f : 1.0f, nullptr, nullptr,
+											   std::is_floating_point_v<ValueType> ? "%.2f" : nullptr);
+				ImGui::PopItemWidth();
+				if (i + 1 < T::length())
+					ImGui::SameLine();
+			}
+			ImGui::PopStyleVar();
+			ImGui::Columns(1);
+			ImGui::PopID();
+			return isChanged;
+		}
+
+		// One widget per field type, returns true when the user changed the value
+		template <class T>
+		bool DrawField(const char* label, T& value, const FieldHints& hints = {})
+		{
+			if constexpr (std::is_floating_point_v<T> || FloatingVector<T>)
+			{
+				if (hints.isAngle)
+				{
+					auto degrees = glm::degrees(value);
+					if (!DrawField(label, degrees, {.resetValue = hints.resetValue}))
+						return false;
+					value = glm::radians(degrees);
+					return true;
+				}
+			}
+
+			if constexpr (std::is_same_v<T, bool>)
+				return ImGui::Checkbox(label, &value);
+			else if constexpr (std::is_arithmetic_v<T>)
+				return ImGui::DragScalar(label, GetDataType<T>(), &value, std::is_floating_point_v<T> ? 0.1f : 1.0f);
+			else if constexpr (std::is_same_v<T, std::string>)
+				return ImGui::InputText(label, &value);
+			else if constexpr (requires { T::length(); })
+				return DrawVectorControl(label, value, hints.resetValue);
+			else
+				static_assert(!sizeof(T), "Field type is not supported by the component inspector");
+		}
+	} // namespace Inspector
+
+	// Editor inspector of a reflected component, generated from its fields. Returns true when any field changed, the
+	// caller marks the component as modified then.
+	template <ReflectedComponent T>
+	bool DrawComponentInspector(T& component)
+	{
+		bool isChanged{};
+		std::apply(
+			[&](const auto&... fields) {
+				((isChanged |= Inspector::DrawField(std::string{fields.name}.c_str(), component.*(fields.member), fields.hints)), ...);
+			},
+			ComponentReflection<T>::fields);
+		return isChanged;
+	}
+} // namespace oe
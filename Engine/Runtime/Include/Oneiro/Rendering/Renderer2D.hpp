@@ -6,6 +6,10 @@
 #pragma once
 
 #include "Oneiro/Common/EngineApi.hpp"
+#include "Oneiro/Common/World/World.hpp"
+#include "Oneiro/Rendering/ShaderLoader.hpp"
+
+#include <bit>
 
 namespace oe
 {
@@ -19,36 +23,21 @@ namespace oe
 	public:
 		static void Initialize()
 		{
-			const char* gVertexSource = R"(
-                #version 460 core
-                layout(location = 0) in vec2 aPos;
-                layout(location = 0) out vec2 Pos;
-                void main()
-                {
-                    Pos = aPos;
-                      gl_Position = vec4(aPos, 0.0, 1.0);
-                }
-            )";
-			const char* gFragmentSource = R"(
-                #version 460 core
-                layout(location = 0) out vec4 oColor;
-                layout(location = 0) in vec2 Pos;
-                void main()
-                {
-                    oColor = vec4(Pos, 0.0, 1.0);
-                }
-            )";
 			data = CreateRef<Data>();
-			auto vert = EngineApi::GetRHI()->CreateShader(RHI::EShaderStage::VERTEX, gVertexSource);
-			auto frag = EngineApi::GetRHI()->CreateShader(RHI::EShaderStage::FRAGMENT, gFragmentSource);
-			data->graphicsPipeline = EngineApi::GetRHI()->CreateGraphicsPipeline({.vertexShader = vert.get(),
-																				  .fragmentShader = frag.get(),
-																				  .vertexInputState = {{RHI::VertexInputBindingDescription{
-																					  .location = 0,
-																					  .binding = 0,
-																					  .format = RHI::Format::R32G32_FLOAT,
-																					  .offset = static_cast<uint32_t>(offsetof(Vertex, vertPos)),
-																				  }}}});
+			// Without its shaders the renderer only clears the screen
+			const auto vert = LoadShader("/Shaders/Renderer2D.vert");
+			const auto frag = LoadShader("/Shaders/Renderer2D.frag");
+			if (vert && frag)
+			{
+				data->graphicsPipeline = EngineApi::GetRHI()->CreateGraphicsPipeline({.vertexShader = vert.get(),
+																					  .fragmentShader = frag.get(),
+																					  .vertexInputState = {{RHI::VertexInputBindingDescription{
+																						  .location = 0,
+																						  .binding = 0,
+																						  .format = RHI::Format::R32G32_FLOAT,
+																						  .offset = static_cast<uint32_t>(offsetof(Vertex, vertPos)),
+																					  }}}});
+			}
 			data->vertexBuffer = EngineApi::GetRHI()->CreateBuffer(data->vertices.data(), data->vertices.size() * sizeof(Vertex));
 			data->renderGraph = EngineApi::GetRHI()->CreateRenderGraph();
 		}
@@ -58,8 +47,23 @@ namespace oe
 			data.reset();
 		}
 
-		static void Draw()
+		// Draws every entity of the current world at its transform interpolated between the last two fixed steps
+		static void Draw(float interpolationAlpha)
 		{
+			data->transforms.clear();
+			if (auto* world = EngineApi::GetWorldManager()->GetWorld())
+				world->GetInterpolatedTransforms(interpolationAlpha, data->transforms);
+
+			const auto instanceCount = static_cast<uint32_t>(data->transforms.size());
+			if (instanceCount > data->transformsCapacity)
+			{
+				data->transformsCapacity = std::bit_ceil(instanceCount);
+				data->transformsBuffer = EngineApi::GetRHI()->CreateBuffer(nullptr, data->transformsCapacity * sizeof(glm::mat4),
+																		  RHI::BufferStorageFlag::DYNAMIC_STORAGE);
+			}
+			if (instanceCount != 0)
+				data->transformsBuffer->UpdateData(data->transforms.data(), instanceCount * sizeof(glm::mat4));
+
 			const auto& windowSize = EngineApi::GetWindowManager()->GetPlatformWindow(0)->GetSize();
 			data->renderGraph->Begin(
 				{
@@ -68,9 +72,13 @@ namespace oe
 					.clearColorValue = {.2f, .0f, .2f, 1.0f},
 				},
 				[&](RHI::ICommandBuffer* commandBuffer) {
+					if (instanceCount == 0 || !data->graphicsPipeline)
+						return;
+
 					commandBuffer->BindGraphicsPipeline(data->graphicsPipeline);
 					commandBuffer->BindVertexBuffer(0, data->vertexBuffer, 0, sizeof(Vertex));
-					commandBuffer->Draw(3, 1, 0, 0);
+					commandBuffer->BindStorageBuffer(0, data->transformsBuffer);
+					commandBuffer->Draw(3, instanceCount, 0, 0);
 				});
 			data->renderGraph->End();
 		}
@@ -82,6 +90,10 @@ namespace oe
 			Ref<RHI::IGraphicsPipeline> graphicsPipeline{};
 			const std::vector<Vertex> vertices = {{{-0.5f, -0.5f}}, {{0.5f, -0.5f}}, {{0.0f, 0.5f}}};
 			Ref<RHI::IBuffer> vertexBuffer;
+			// Refilled every frame, one transform per drawn entity
+			std::vector<glm::mat4> transforms{};
+			Ref<RHI::IBuffer> transformsBuffer{};
+			uint32_t transformsCapacity{};
 		};
 		inline static Ref<Data> data{};
 	};
@@ -0,0 +1,36 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include "Oneiro/Common/Assets/Cookers.hpp"
+#include "Oneiro/Common/EngineApi.hpp"
+
+#include <cstring>
+
+namespace oe
+{
+	// Shaders are read cooked like every other asset (see ShaderCooker), the stage comes from the cooked data.
+	// Returns nullptr when the shader is missing or was not cooked.
+	inline Ref<RHI::IShader> LoadShader(const FileSystem::Path& path)
+	{
+		std::string data{};
+		CookedShader shader{};
+		if (!EngineApi::GetAssetsManager()->GetCooker()->ReadCooked(path, ECookedAssetType::SHADER, data) || data.size() < sizeof(shader))
+		{
+			OE_CORE_ERROR("Failed to load shader '{}'!", path.string());
+			return nullptr;
+		}
+
+		std::memcpy(&shader, data.data(), sizeof(shader));
+		if (shader.sourceSize > data.size() - sizeof(shader))
+		{
+			OE_CORE_ERROR("Cooked shader '{}' is truncated!", path.string());
+			return nullptr;
+		}
+
+		return EngineApi::GetRHI()->CreateShader(shader.stage, data.substr(sizeof(shader), shader.sourceSize));
+	}
+} // namespace oe
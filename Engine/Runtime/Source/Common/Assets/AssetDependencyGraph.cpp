@@ -0,0 +1,62 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#include "Oneiro/Common/Assets/AssetDependencyGraph.hpp"
+
+#include <algorithm>
+
+namespace oe
+{
+	bool AssetDependencyGraph::Build(IAssetsProvider* provider, const Ref<IAsset>& root, const Resolver& resolver)
+	{
+		m_Nodes.clear();
+		m_Visited.clear();
+
+		std::vector<AssetDependency> path{};
+		return Visit(provider, root, resolver, path);
+	}
+
+	bool AssetDependencyGraph::Visit(IAssetsProvider* provider, const Ref<IAsset>& asset, const Resolver& resolver, std::vector<AssetDependency>& path)
+	{
+		const AssetDependency key{asset->GetDataType(), asset->GetAssetInfo()->GetHash()};
+		m_Visited[key] = {EVisitState::VISITING, 0};
+		path.emplace_back(key);
+
+		std::vector<size_t> dependencies{};
+		for (const auto& dependencyKey : asset->GetAssetInfo()->GetDependencies())
+		{
+			const auto& visited = m_Visited.find(dependencyKey);
+			if (visited != m_Visited.end())
+			{
+				if (visited->second.first == EVisitState::VISITING)
+				{
+					std::string cycle{};
+					for (auto iter = std::find(path.begin(), path.end(), dependencyKey); iter != path.end(); ++iter)
+						cycle += fmt::format("'{}' -> ", iter->hash);
+					OE_CORE_ERROR("Asset dependency cycle detected: {}'{}'", cycle, dependencyKey.hash);
+					return false;
+				}
+				dependencies.emplace_back(visited->second.second);
+				continue;
+			}
+
+			const auto& [dependencyProvider, dependency] = resolver(dependencyKey);
+			if (!dependencyProvider || !dependency)
+			{
+				OE_CORE_ERROR("Asset with '{}' hash depends on unknown asset with '{}' hash!", key.hash, dependencyKey.hash);
+				return false;
+			}
+
+			if (!Visit(dependencyProvider, dependency, resolver, path))
+				return false;
+			dependencies.emplace_back(m_Visited[dependencyKey].second);
+		}
+
+		path.pop_back();
+		m_Visited[key] = {EVisitState::VISITED, m_Nodes.size()};
+		m_Nodes.push_back({provider, asset, std::move(dependencies)});
+		return true;
+	}
+} // namespace oe
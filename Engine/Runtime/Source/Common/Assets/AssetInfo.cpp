@@ -5,11 +5,32 @@
 
 #include "Oneiro/Common/Assets/AssetInfo.hpp"
 
+#include <algorithm>
+
 size_t oe::AssetInfo::GetHash() const noexcept
 {
 	return m_Hash;
 }
 
+void oe::AssetInfo::AddDependency(const AssetDependency& dependency)
+{
+	std::lock_guard lock(m_DependenciesMutex);
+	if (std::find(m_Dependencies.begin(), m_Dependencies.end(), dependency) == m_Dependencies.end())
+		m_Dependencies.emplace_back(dependency);
+}
+
+std::vector<oe::AssetDependency> oe::AssetInfo::GetDependencies() const
+{
+	std::lock_guard lock(m_DependenciesMutex);
+	return m_Dependencies;
+}
+
+bool oe::AssetInfo::HasDependencies() const
+{
+	std::lock_guard lock(m_DependenciesMutex);
+	return !m_Dependencies.empty();
+}
+
 bool oe::AssetInfo::operator==(size_t hash) const noexcept
 {
 	return m_Hash == hash;
@@ -0,0 +1,313 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#include "Oneiro/Common/Assets/AssetsCooker.hpp"
+#include "Oneiro/Common/Assets/AssetsPreloader.hpp"
+
+#include "Oneiro/Common/FileSystem/FileSystem.hpp"
+#include "Oneiro/Common/JobManager.hpp"
+
+#include "xxhash.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstring>
+#include <fstream>
+#include <memory>
+
+namespace oe
+{
+	namespace
+	{
+		// Key of an existing cooked file, 0 when it is missing or not a cooked file
+		uint64_t ReadCookedKey(const FileSystem::Path& path)
+		{
+			std::ifstream file(path, std::ios::binary);
+			CookedAssetHeader header{};
+			if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)) || header.magic != CookedAssetHeader::Magic)
+				return 0;
+			return header.key;
+		}
+
+		std::string ToLower(std::string value)
+		{
+			std::transform(value.begin(), value.end(), value.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+			return value;
+		}
+
+		std::string GetExtension(const FileSystem::Path& path)
+		{
+			return ToLower(path.extension().string());
+		}
+	} // namespace
+
+	void AssetsCooker::RegisterCooker(const std::string& extension, const Ref<IAssetCooker>& cooker)
+	{
+		m_Cookers[ToLower(extension)] = cooker;
+	}
+
+	const IAssetCooker* AssetsCooker::GetCooker(const FileSystem::Path& path) const
+	{
+		const auto& cooker = m_Cookers.find(GetExtension(path));
+		return cooker != m_Cookers.end() ? cooker->second.get() : nullptr;
+	}
+
+	AssetsCooker::Stats AssetsCooker::CookDirectory(const FileSystem::Path& sourceDirectory, const FileSystem::Path& outputDirectory) const
+	{
+		std::vector<FileSystem::Path> sources{};
+		std::error_code error{};
+		for (const auto& file : std::filesystem::recursive_directory_iterator(sourceDirectory, error))
+		{
+			if (file.is_regular_file() && GetCooker(file.path()))
+				sources.emplace_back(file.path());
+		}
+
+		if (error)
+		{
+			OE_CORE_ERROR("Failed to iterate '{}': {}", sourceDirectory.string(), error.message());
+			return {};
+		}
+
+		// Sorted so logs and failures come out in the same order on every machine
+		std::sort(sources.begin(), sources.end());
+
+		std::atomic<uint32_t> cooked{};
+		std::atomic<uint32_t> upToDate{};
+		std::atomic<uint32_t> failed{};
+		JobManager::ParallelFor(sources.size(), [&](size_t index) {
+			const auto& sourcePath = sources[index];
+			const FileSystem::Path outputPath = outputDirectory / std::filesystem::relative(sourcePath, sourceDirectory);
+
+			// Sources are hashed and parsed once, mapping them saves a copy of every file
+			FileSystem::MappedFile sourceFile{};
+			if (!sourceFile.Open(sourcePath, FileSystem::EMapAccess::SEQUENTIAL))
+			{
+				OE_CORE_ERROR("Failed to read '{}' for cooking!", sourcePath.string());
+				failed.fetch_add(1);
+				return;
+			}
+
+			const auto source = sourceFile.GetData();
+			if (ReadCookedKey(outputPath) == GetCacheKey(sourcePath, *GetCooker(sourcePath), source))
+			{
+				upToDate.fetch_add(1);
+				return;
+			}
+
+			std::vector<std::byte> data{};
+			if (!Cook(sourcePath, source, data))
+			{
+				failed.fetch_add(1);
+				return;
+			}
+
+			// Written next to the output and renamed, so an interrupted cook never leaves a valid looking partial file
+			std::error_code directoryError{};
+			std::filesystem::create_directories(outputPath.parent_path(), directoryError);
+			auto temporaryPath = outputPath;
+			temporaryPath += ".tmp";
+			{
+				std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+				file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+				if (!file)
+				{
+					OE_CORE_ERROR("Failed to write cooked asset '{}'!", outputPath.string());
+					failed.fetch_add(1);
+					return;
+				}
+			}
+
+			std::error_code renameError{};
+			std::filesystem::rename(temporaryPath, outputPath, renameError);
+			if (renameError)
+			{
+				OE_CORE_ERROR("Failed to write cooked asset '{}': {}", outputPath.string(), renameError.message());
+				failed.fetch_add(1);
+				return;
+			}
+			cooked.fetch_add(1);
+		});
+
+		// Written around FileSystem, the output may be mounted
+		FileSystem::RefreshIndex(outputDirectory);
+
+		const Stats stats{cooked.load(), upToDate.load(), failed.load()};
+		OE_CORE_INFO("Cooked '{}': {} cooked, {} up to date, {} failed", sourceDirectory.string(), stats.cooked, stats.upToDate, stats.failed);
+		return stats;
+	}
+
+	bool AssetsCooker::Cook(const FileSystem::Path& path, std::span<const std::byte> source, std::vector<std::byte>& cooked) const
+	{
+		const auto* cooker = GetCooker(path);
+		if (!cooker)
+		{
+			OE_CORE_ERROR("No cooker for '{}'!", path.string());
+			return false;
+		}
+
+		std::vector<std::byte> payload{};
+		if (!cooker->Cook(path, source, payload))
+		{
+			OE_CORE_ERROR("Failed to cook '{}'!", path.string());
+			return false;
+		}
+
+		CookedAssetHeader header{};
+		header.type = cooker->GetType();
+		header.version = cooker->GetVersion();
+		header.key = GetCacheKey(path, *cooker, source);
+		header.payloadSize = payload.size();
+
+		cooked.resize(sizeof(header) + payload.size());
+		std::memcpy(cooked.data(), &header, sizeof(header));
+		std::memcpy(cooked.data() + sizeof(header), payload.data(), payload.size());
+		return true;
+	}
+
+	bool AssetsCooker::ReadCooked(const FileSystem::Path& path, ECookedAssetType type, std::string& data) const
+	{
+		bool isSource{};
+		return ReadCooked(path, type, data, isSource);
+	}
+
+	bool AssetsCooker::ReadCooked(const FileSystem::Path& path, ECookedAssetType type, std::string& data, bool& isSource) const
+	{
+		if (m_Preloader)
+			m_Preloader->Record(path);
+
+		// A missing file is not an error, providers decide what an absent asset means
+		if (!m_Preloader || !m_Preloader->Take(path, data))
+			data = FileSystem::Read(path);
+		return ProcessCooked(path, type, data, isSource);
+	}
+
+	bool AssetsCooker::ReadCookedAsync(const FileSystem::Path& path, ECookedAssetType type, std::string& data,
+									   FileSystem::ReadCallback callback, bool* isSource) const
+	{
+		if (m_Preloader)
+		{
+			m_Preloader->Record(path);
+			if (m_Preloader->Take(path, data))
+			{
+				FinishCookedAsync(path, type, data, std::move(callback), isSource);
+				return true;
+			}
+		}
+
+		FileSystem::ReadAsync(path, data, [this, path, type, &data, callback = std::move(callback), isSource](bool isRead) mutable {
+			// Same as ReadCooked, a file that can't be read is a missing asset
+			if (!isRead)
+				data.clear();
+			FinishCookedAsync(path, type, data, std::move(callback), isSource);
+		});
+		return true;
+	}
+
+	void AssetsCooker::FinishCookedAsync(const FileSystem::Path& path, ECookedAssetType type, std::string& data,
+										 FileSystem::ReadCallback callback, bool* isSource) const
+	{
+		auto process = [this, path, type, &data, callback = std::move(callback), isSource] {
+			bool isSourceFile{};
+			const auto isProcessed = ProcessCooked(path, type, data, isSourceFile);
+			if (isSource)
+				*isSource = isSourceFile;
+			callback(isProcessed);
+		};
+
+		// Cooked data only loses its header. Sources cooked on demand are cooked on a worker, so neither the IO thread
+		// nor the caller stalls, and on the IO pool when every worker is taken.
+		if (!m_IsCookOnDemand || IsCooked(data))
+		{
+			process();
+			return;
+		}
+		if (!JobManager::TryAddTask(process))
+			FileSystem::RunAsync(std::move(process));
+	}
+
+	bool AssetsCooker::IsCooked(std::string_view data) noexcept
+	{
+		if (data.empty())
+			return true;
+
+		CookedAssetHeader header{};
+		if (data.size() >= sizeof(header))
+			std::memcpy(&header, data.data(), sizeof(header));
+		return header.magic == CookedAssetHeader::Magic;
+	}
+
+	bool AssetsCooker::ProcessCooked(const FileSystem::Path& path, ECookedAssetType type, std::string& data, bool& isSource) const
+	{
+		isSource = true;
+		if (data.empty())
+			return true;
+
+		CookedAssetHeader header{};
+		if (data.size() >= sizeof(header))
+			std::memcpy(&header, data.data(), sizeof(header));
+
+		if (header.magic == CookedAssetHeader::Magic)
+		{
+			isSource = false;
+			if (header.type != type || header.payloadSize != data.size() - sizeof(header))
+			{
+				OE_CORE_ERROR("Cooked asset '{}' is corrupted or has a different type!", path.string());
+				return false;
+			}
+
+			// The source isn't at hand here, so a stale file can't be cooked again on demand
+			const auto* cooker = GetCooker(path);
+			if (!cooker)
+			{
+				OE_CORE_ERROR("Cooked asset '{}' has no registered cooker!", path.string());
+				return false;
+			}
+			if (header.version != cooker->GetVersion())
+			{
+				OE_CORE_ERROR("Cooked asset '{}' is from version {} of its cooker, expected {}! Cook it again.", path.string(),
+							  header.version, cooker->GetVersion());
+				return false;
+			}
+
+			data.erase(0, sizeof(header));
+			return true;
+		}
+
+		const auto* cooker = GetCooker(path);
+		if (!m_IsCookOnDemand || !cooker || cooker->GetType() != type)
+		{
+			OE_CORE_ERROR("Asset '{}' is not cooked!", path.string());
+			return false;
+		}
+
+		std::vector<std::byte> payload{};
+		if (!cooker->Cook(path, std::as_bytes(std::span{data}), payload))
+		{
+			OE_CORE_ERROR("Failed to cook '{}' on demand!", path.string());
+			return false;
+		}
+
+		data.assign(reinterpret_cast<const char*>(payload.data()), payload.size());
+		return true;
+	}
+
+	uint64_t AssetsCooker::GetCacheKey(const FileSystem::Path& path, const IAssetCooker& cooker, std::span<const std::byte> source) const
+	{
+		const auto extension = GetExtension(path);
+		const auto type = cooker.GetType();
+		const auto version = cooker.GetVersion();
+		const auto settings = cooker.GetSettings();
+
+		const std::unique_ptr<XXH3_state_t, decltype(&XXH3_freeState)> state{XXH3_createState(), &XXH3_freeState};
+		XXH3_64bits_reset(state.get());
+		XXH3_64bits_update(state.get(), source.data(), source.size());
+		XXH3_64bits_update(state.get(), extension.data(), extension.size());
+		XXH3_64bits_update(state.get(), &type, sizeof(type));
+		XXH3_64bits_update(state.get(), &version, sizeof(version));
+		XXH3_64bits_update(state.get(), settings.data(), settings.size());
+		return XXH3_64bits_digest(state.get());
+	}
+} // namespace oe
@@ -4,12 +4,80 @@
 //
 
 #include "Oneiro/Common/Assets/AssetsManager.hpp"
+#include "Oneiro/Common/Assets/AssetDependencyGraph.hpp"
+#include "Oneiro/Common/Assets/Cookers.hpp"
+#include "Oneiro/Common/FileSystem/FileSystem.hpp"
 
-void oe::AssetsManager::LoadAssetsAsync()
+#include "rapidjson/document.h"
+#include "rapidjson/prettywriter.h"
+#include "rapidjson/stringbuffer.h"
+
+#include <limits>
+
+namespace
+{
+	// Quoted as in RFC 4180, so names with commas, quotes or line breaks keep the row intact
+	std::string QuoteCsvField(std::string_view field)
+	{
+		std::string quoted{"\""};
+		for (const auto character : field)
+		{
+			if (character == '"')
+				quoted += '"';
+			quoted += character;
+		}
+		quoted += '"';
+		return quoted;
+	}
+} // namespace
+
+oe::AssetsManager::AssetsManager()
+{
+	m_Cooker.SetPreloader(&m_Preloader);
+
+	m_Cooker.RegisterCooker(".oeworld", CreateRef<WorldCooker>());
+
+	const auto textureCooker = CreateRef<TextureCooker>();
+	for (const auto* extension : {".png", ".jpg", ".jpeg", ".tga", ".bmp"})
+		m_Cooker.RegisterCooker(extension, textureCooker);
+
+	const auto shaderCooker = CreateRef<ShaderCooker>();
+	m_Cooker.RegisterCooker(".vert", shaderCooker);
+	m_Cooker.RegisterCooker(".frag", shaderCooker);
+}
+
+void oe::AssetsManager::Update()
 {
+	std::vector<DeferredStream> deferredStreams{};
+	{
+		std::lock_guard lock(m_DeferredStreamsMutex);
+		deferredStreams.swap(m_DeferredStreams);
+	}
+	for (auto& stream : deferredStreams)
+		StreamAsset(stream.provider, stream.asset, stream.priority, std::move(stream.callback));
+
+	m_Preloader.Update();
+	m_Streamer.Update();
+	if (const auto isStreaming = !m_Streamer.IsIdle(); isStreaming != m_IsStreaming)
+	{
+		m_IsStreaming = isStreaming;
+		if (!isStreaming)
+		{
+			// The load is complete, prefetched files that were not taken by now are not held any longer
+			m_Preloader.ReleaseUntaken();
+			if (!m_LoadReportPath.empty())
+				DumpLoadStats(m_LoadReportPath);
+		}
+	}
+	for (const auto& assetsProvider : m_AssetsProviders)
+		assetsProvider.second->Update();
+
+	// Providers keep their clock hand between frames, so eviction of a large cache is spread over several updates
+	const auto deadline = std::chrono::steady_clock::now() + m_EvictionTimeSlice;
 	for (const auto& assetsProvider : m_AssetsProviders)
 	{
-		assetsProvider.second->LoadAssetsAsync();
+		if (!assetsProvider.second->EvictAssets(deadline))
+			break;
 	}
 }
 
@@ -19,4 +87,162 @@ void oe::AssetsManager::CollectGarbage()
 	{
 		assetsProvider.second->CollectGarbage();
 	}
-}
\ No newline at end of file
+}
+
+void oe::AssetsManager::DumpLoadStats(const FileSystem::Path& path) const
+{
+	const auto isCsv = path.extension() == ".csv";
+	std::string output = isCsv ? "name,hash,triggered_by,loads,failed,async_read,queue_wait_ms,read_ms,decode_ms,finalize_ms,upload_ms,total_ms,"
+								 "disk_bytes,cpu_bytes,gpu_bytes\n"
+							   : std::string{};
+
+	rapidjson::Document document{};
+	document.SetArray();
+	auto& allocator = document.GetAllocator();
+
+	// Names are only known for ids interned in debug builds, the hash is written either way
+	const auto getName = [](size_t hash) {
+		const auto name = StringId::FromValue(hash).GetString();
+		return name.empty() ? fmt::format("{:016x}", hash) : std::string{name};
+	};
+
+	ForEachAsset([&](const Ref<IAsset>& asset) {
+		const auto& stats = asset->GetLoadStats();
+		if (stats.loadsCount == 0)
+			return;
+
+		const auto hash = asset->GetAssetInfo()->GetHash();
+		const auto& memory = asset->GetMemoryUsage();
+		const auto name = getName(hash);
+		const auto hashString = fmt::format("{:016x}", hash);
+		const auto triggeredBy = stats.triggeredBy ? getName(stats.triggeredBy) : std::string{};
+		if (isCsv)
+		{
+			output += fmt::format("{},{},{},{},{},{},{:.3f},{:.3f},{:.3f},{:.3f},{:.3f},{:.3f},{},{},{}\n", QuoteCsvField(name), hashString,
+								  QuoteCsvField(triggeredBy), stats.loadsCount, stats.isFailed, stats.isAsyncRead, stats.queueWait, stats.read, stats.decode,
+								  stats.finalize, stats.upload, stats.GetTotal(), stats.diskSize, memory.cpu, memory.gpu);
+			return;
+		}
+
+		rapidjson::Value entry{rapidjson::kObjectType};
+		entry.AddMember("name", rapidjson::Value(name.c_str(), allocator), allocator);
+		entry.AddMember("hash", rapidjson::Value(hashString.c_str(), allocator), allocator);
+		entry.AddMember("triggeredBy", rapidjson::Value(triggeredBy.c_str(), allocator), allocator);
+		entry.AddMember("loads", stats.loadsCount, allocator);
+		entry.AddMember("failed", stats.isFailed, allocator);
+		entry.AddMember("asyncRead", stats.isAsyncRead, allocator);
+		entry.AddMember("queueWaitMs", stats.queueWait, allocator);
+		entry.AddMember("readMs", stats.read, allocator);
+		entry.AddMember("decodeMs", stats.decode, allocator);
+		entry.AddMember("finalizeMs", stats.finalize, allocator);
+		entry.AddMember("uploadMs", stats.upload, allocator);
+		entry.AddMember("totalMs", stats.GetTotal(), allocator);
+		entry.AddMember("diskBytes", static_cast<uint64_t>(stats.diskSize), allocator);
+		entry.AddMember("cpuBytes", static_cast<uint64_t>(memory.cpu), allocator);
+		entry.AddMember("gpuBytes", static_cast<uint64_t>(memory.gpu), allocator);
+		document.PushBack(entry, allocator);
+	});
+
+	if (!isCsv)
+	{
+		rapidjson::StringBuffer writerBuffer;
+		rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(writerBuffer);
+		document.Accept(writer);
+		output.assign(writerBuffer.GetString(), writerBuffer.GetSize());
+	}
+
+	FileSystem::Write(path, reinterpret_cast<const uint8_t*>(output.data()), output.size());
+	OE_CORE_INFO("Asset load stats written to '{}'", path.string());
+}
+
+void oe::AssetsManager::Shutdown()
+{
+	{
+		std::lock_guard lock(m_DeferredStreamsMutex);
+		m_DeferredStreams.clear();
+	}
+	m_Preloader.Cancel();
+	m_Streamer.CancelAll();
+	m_Streamer.Flush();
+	for (const auto& assetsProvider : m_AssetsProviders)
+		assetsProvider.second->Shutdown();
+	CollectGarbage();
+}
+
+bool oe::AssetsManager::LoadAsset(IAssetsProvider* provider, const Ref<IAsset>& asset)
+{
+	// Finalizing belongs to the main thread, other threads get the asset streamed instead of blocking on it
+	if (!IsMainThread())
+	{
+		StreamAsset(provider, asset);
+		return false;
+	}
+
+	// Goes through the streamer as well, so a load never overlaps with a streaming request of the same asset.
+	// Dependencies still decode in parallel, the caller only blocks until the whole graph is finalized.
+	const auto request = StreamAsset(provider, asset, std::numeric_limits<float>::lowest());
+	if (!request)
+		return false;
+
+	m_Streamer.Flush(request);
+	return request->GetState() == EAssetStreamState::DONE;
+}
+
+oe::Ref<oe::AssetStreamRequest> oe::AssetsManager::StreamAsset(IAssetsProvider* provider, const Ref<IAsset>& asset, float priority,
+															   AssetStreamCallback callback)
+{
+	// The streamer is main thread only, requests from other threads are started by the next Update and can only be
+	// followed through their callback
+	if (!IsMainThread())
+	{
+		std::lock_guard lock(m_DeferredStreamsMutex);
+		m_DeferredStreams.push_back({provider, asset, priority, std::move(callback)});
+		return nullptr;
+	}
+
+	// A loaded root has its dependencies loaded as well, the streamer completes the request right away
+	if (!asset->GetAssetInfo()->HasDependencies() || asset->IsLoaded())
+		return m_Streamer.Request(provider, asset, priority, std::move(callback));
+
+	AssetDependencyGraph graph{};
+	if (!graph.Build(provider, asset, [this](const AssetDependency& dependency) { return FindAsset(dependency); }))
+	{
+		OE_CORE_ERROR("Failed to stream asset with '{}' hash, dependencies are invalid!", asset->GetAssetInfo()->GetHash());
+		return nullptr;
+	}
+
+	// Nodes come in topological order, so every dependency request exists before its dependents are requested.
+	// Independent branches of the graph are read and decoded in parallel.
+	const auto& nodes = graph.GetNodes();
+	std::vector<Ref<AssetStreamRequest>> requests(nodes.size());
+	for (size_t i{}; i < nodes.size(); ++i)
+	{
+		const auto& node = nodes[i];
+		const auto isRoot = i + 1 == nodes.size();
+		if (node.asset->IsLoaded())
+			continue;
+
+		std::vector<Ref<AssetStreamRequest>> dependencies{};
+		for (const auto dependency : node.dependencies)
+		{
+			if (requests[dependency])
+				dependencies.emplace_back(requests[dependency]);
+		}
+
+		requests[i] = m_Streamer.Request(node.provider, node.asset, priority, isRoot ? std::move(callback) : AssetStreamCallback{},
+										 dependencies);
+		if (!isRoot && requests[i])
+			requests[i]->SetTriggeredBy(asset->GetAssetInfo()->GetHash());
+	}
+	return requests.back();
+}
+
+std::pair<oe::IAssetsProvider*, oe::Ref<oe::IAsset>> oe::AssetsManager::FindAsset(const AssetDependency& dependency) const
+{
+	const auto& assetsProvider = m_AssetsProviders.find(dependency.type);
+	if (assetsProvider == m_AssetsProviders.end())
+		return {nullptr, nullptr};
+	if (auto asset = assetsProvider->second->FindAsset(dependency.hash))
+		return {assetsProvider->second.get(), asset};
+	return {nullptr, nullptr};
+}
@@ -0,0 +1,246 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#include "Oneiro/Common/Assets/AssetsPreloader.hpp"
+
+#include "Oneiro/Common/FileSystem/FileSystem.hpp"
+#include "Oneiro/Common/JobManager.hpp"
+
+#include <charconv>
+
+namespace oe
+{
+	namespace
+	{
+		// Reads of one job, so the preload never holds a worker for long
+		constexpr size_t PreloadBatchBytes = 16ull << 20;
+
+		std::string GetPreloadKey(const FileSystem::Path& path)
+		{
+			return path.lexically_normal().generic_string();
+		}
+	} // namespace
+
+	AssetsPreloader::~AssetsPreloader()
+	{
+		Cancel();
+		while (m_IsReading.load())
+			JobManager::Poll();
+	}
+
+	void AssetsPreloader::StartRecording()
+	{
+		std::lock_guard lock(m_Mutex);
+		m_Recorded.clear();
+		m_RecordedPaths.clear();
+		m_RecordingStart = std::chrono::steady_clock::now();
+		m_IsRecording.store(true);
+	}
+
+	bool AssetsPreloader::StopRecording(const FileSystem::Path& manifestPath)
+	{
+		std::string output{};
+		{
+			std::lock_guard lock(m_Mutex);
+			m_IsRecording.store(false);
+			for (const auto& entry : m_Recorded)
+				output += fmt::format("{:.3f}\t{}\n", entry.time, entry.path);
+			m_Recorded.clear();
+			m_RecordedPaths.clear();
+		}
+
+		if (output.empty())
+		{
+			OE_CORE_WARN("Nothing was read while recording '{}'!", manifestPath.string());
+			return false;
+		}
+
+		FileSystem::Write(manifestPath, reinterpret_cast<const uint8_t*>(output.data()), output.size());
+		return true;
+	}
+
+	bool AssetsPreloader::Preload(const FileSystem::Path& manifestPath)
+	{
+		const auto data = FileSystem::Read(manifestPath);
+		std::vector<Entry> manifest{};
+		std::string_view lines{data};
+		while (!lines.empty())
+		{
+			const auto end = lines.find('\n');
+			const auto line = lines.substr(0, end);
+			lines.remove_prefix(end == std::string_view::npos ? lines.size() : end + 1);
+
+			const auto separator = line.find('\t');
+			if (separator == std::string_view::npos)
+				continue;
+
+			Entry entry{};
+			std::from_chars(line.data(), line.data() + separator, entry.time);
+			entry.path = line.substr(separator + 1);
+			if (!entry.path.empty() && entry.path.back() == '\r')
+				entry.path.pop_back();
+			manifest.emplace_back(std::move(entry));
+		}
+
+		if (manifest.empty())
+		{
+			OE_CORE_WARN("Preload manifest '{}' is missing or empty!", manifestPath.string());
+			return false;
+		}
+
+		Cancel();
+		{
+			std::lock_guard lock(m_Mutex);
+			m_Manifest = std::move(manifest);
+		}
+
+		// The first job reads up to the memory limit, preloads usually start during initialization, long before Update
+		if (!m_IsReading.exchange(true))
+		{
+			JobManager::AddTask([this] {
+				ReadBatch(m_MaxPrefetchedBytes);
+				m_IsReading.store(false);
+			});
+		}
+		return true;
+	}
+
+	void AssetsPreloader::Cancel()
+	{
+		std::lock_guard lock(m_Mutex);
+		m_Manifest.clear();
+		m_Prefetched.clear();
+		m_Taken.clear();
+		m_NextEntry = 0;
+		m_PrefetchedBytes = 0;
+		++m_Generation;
+	}
+
+	bool AssetsPreloader::ReleaseUntaken()
+	{
+		std::lock_guard lock(m_Mutex);
+		if (m_Manifest.empty())
+			return true;
+		if (m_NextEntry < m_Manifest.size())
+			return false;
+
+		if (!m_Prefetched.empty())
+			OE_CORE_INFO("Released {} preloaded asset files ({} bytes) that were never read", m_Prefetched.size(), m_PrefetchedBytes);
+		m_Manifest.clear();
+		m_Prefetched.clear();
+		m_Taken.clear();
+		m_NextEntry = 0;
+		m_PrefetchedBytes = 0;
+		// The last file of the manifest may still be read
+		++m_Generation;
+		return true;
+	}
+
+	void AssetsPreloader::Update()
+	{
+		if (m_IsReading.load())
+			return;
+
+		{
+			std::lock_guard lock(m_Mutex);
+			if (m_Manifest.empty())
+				return;
+
+			// Everything was read and handed out, the manifest is not needed anymore
+			if (m_NextEntry >= m_Manifest.size() && m_Prefetched.empty())
+			{
+				OE_CORE_INFO("Preloaded {} asset files", m_Manifest.size());
+				m_Manifest.clear();
+				m_Taken.clear();
+				m_NextEntry = 0;
+				return;
+			}
+
+			if (m_NextEntry >= m_Manifest.size() || m_PrefetchedBytes >= m_MaxPrefetchedBytes)
+				return;
+		}
+
+		m_IsReading.store(true);
+		JobManager::AddTask([this] {
+			ReadBatch(PreloadBatchBytes);
+			m_IsReading.store(false);
+		});
+	}
+
+	void AssetsPreloader::Record(const FileSystem::Path& path)
+	{
+		if (!IsRecording())
+			return;
+
+		auto key = GetPreloadKey(path);
+		const auto now = std::chrono::steady_clock::now();
+
+		std::lock_guard lock(m_Mutex);
+		if (m_IsRecording.load() && m_RecordedPaths.emplace(key).second)
+			m_Recorded.push_back({std::move(key), std::chrono::duration<float, std::milli>(now - m_RecordingStart).count()});
+	}
+
+	bool AssetsPreloader::Take(const FileSystem::Path& path, std::string& data)
+	{
+		const auto key = GetPreloadKey(path);
+
+		std::lock_guard lock(m_Mutex);
+		if (m_Manifest.empty())
+			return false;
+
+		m_Taken.emplace(key);
+		const auto& prefetched = m_Prefetched.find(key);
+		if (prefetched == m_Prefetched.end())
+			return false;
+
+		data = std::move(prefetched->second);
+		m_PrefetchedBytes -= data.size();
+		m_Prefetched.erase(prefetched);
+		return true;
+	}
+
+	bool AssetsPreloader::IsPreloading() const noexcept
+	{
+		std::lock_guard lock(m_Mutex);
+		return m_NextEntry < m_Manifest.size();
+	}
+
+	size_t AssetsPreloader::GetPrefetchedBytes() const noexcept
+	{
+		std::lock_guard lock(m_Mutex);
+		return m_PrefetchedBytes;
+	}
+
+	void AssetsPreloader::ReadBatch(size_t maxBytes)
+	{
+		size_t batchBytes{};
+		while (batchBytes < maxBytes)
+		{
+			std::string path{};
+			uint32_t generation{};
+			{
+				std::lock_guard lock(m_Mutex);
+				while (m_NextEntry < m_Manifest.size() && m_Taken.contains(m_Manifest[m_NextEntry].path))
+					++m_NextEntry;
+				if (m_NextEntry >= m_Manifest.size() || m_PrefetchedBytes >= m_MaxPrefetchedBytes)
+					return;
+				path = m_Manifest[m_NextEntry++].path;
+				generation = m_Generation;
+			}
+
+			// Read without the lock, Take keeps working for the files that are already prefetched
+			auto data = FileSystem::Read(path);
+			batchBytes += data.size();
+
+			std::lock_guard lock(m_Mutex);
+			// Taken while it was read, or the preload was cancelled or replaced in the meantime
+			if (data.empty() || generation != m_Generation || m_Taken.contains(path))
+				continue;
+
+			m_PrefetchedBytes += data.size();
+			m_Prefetched.emplace(std::move(path), std::move(data));
+		}
+	}
+} // namespace oe
@@ -0,0 +1,335 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#include "Oneiro/Common/Assets/AssetsStreamer.hpp"
+
+#include "Oneiro/Common/JobManager.hpp"
+
+namespace oe
+{
+	AssetsStreamer::~AssetsStreamer()
+	{
+		CancelAll();
+		while (m_IOJobs.load() > 0 || m_DecodeJobs.load() > 0 || m_AsyncReads.load() > 0)
+			JobManager::Poll();
+	}
+
+	Ref<AssetStreamRequest> AssetsStreamer::Request(IAssetsProvider* provider, const Ref<IAsset>& asset, float priority,
+													AssetStreamCallback callback, const std::vector<Ref<AssetStreamRequest>>& dependencies)
+	{
+		const auto& active = m_Active.find(asset.get());
+		if (active != m_Active.end() && !active->second->IsCancelled())
+		{
+			Merge(*active->second, priority, std::move(callback), dependencies);
+			return active->second;
+		}
+
+		// The cancelled request may still be read or decoded on a worker, the new one starts after it is done
+		if (active != m_Active.end())
+		{
+			auto& chained = m_Chained[asset.get()];
+			if (chained && !chained->IsCancelled())
+			{
+				Merge(*chained, priority, std::move(callback), dependencies);
+				return chained;
+			}
+
+			// A chained request that was cancelled never started, it is simply replaced
+			if (chained)
+				chained->m_State.store(EAssetStreamState::CANCELLED);
+			chained = CreateRef<AssetStreamRequest>(provider, asset, priority);
+			Merge(*chained, priority, std::move(callback), dependencies);
+			return chained;
+		}
+
+		auto request = CreateRef<AssetStreamRequest>(provider, asset, priority);
+		if (asset->IsLoaded())
+		{
+			request->m_State.store(EAssetStreamState::DONE);
+			if (callback)
+				callback(asset, true);
+			return request;
+		}
+
+		Merge(*request, priority, std::move(callback), dependencies);
+		m_Active[asset.get()] = request;
+		m_ReadQueue.emplace_back(request);
+		return request;
+	}
+
+	void AssetsStreamer::Merge(AssetStreamRequest& request, float priority, AssetStreamCallback&& callback,
+							   const std::vector<Ref<AssetStreamRequest>>& dependencies)
+	{
+		request.SetPriority(std::min(request.GetPriority(), priority));
+		if (callback)
+			request.m_Callbacks.emplace_back(std::move(callback));
+		request.m_Dependencies.insert(request.m_Dependencies.end(), dependencies.begin(), dependencies.end());
+	}
+
+	void AssetsStreamer::Update()
+	{
+		{
+			std::lock_guard lock(m_FinishedMutex);
+			m_FinishedSwap.swap(m_Finished);
+		}
+
+		for (const auto& request : m_FinishedSwap)
+		{
+			if (request->IsCancelled())
+			{
+				Complete(request, EAssetStreamState::CANCELLED);
+				continue;
+			}
+
+			switch (request->GetState())
+			{
+				case EAssetStreamState::READ: m_DecodeQueue.emplace_back(request); break;
+				case EAssetStreamState::DECODED: m_FinalizeQueue.emplace_back(request); break;
+				default: Complete(request, EAssetStreamState::FAILED); break;
+			}
+		}
+		m_FinishedSwap.clear();
+
+		FinalizeReady();
+
+		Dispatch(m_DecodeQueue, m_DecodeJobs, m_MaxDecodeJobs, true);
+		Dispatch(m_ReadQueue, m_IOJobs, m_MaxIOJobs, false);
+	}
+
+	void AssetsStreamer::FinalizeReady()
+	{
+		// Dependencies are always requested before their dependents, so a pass in queue order mostly resolves whole
+		// chains that became ready in the same update. Another pass only runs when the last one finalized something,
+		// a finalized dependency may unblock requests that were checked before it. The queue is swapped out for every
+		// pass, callbacks may stream assets and update the streamer again.
+		for (bool isProgress{true}; isProgress && !m_FinalizeQueue.empty();)
+		{
+			isProgress = false;
+			std::vector<Ref<AssetStreamRequest>> pending{};
+			pending.swap(m_FinalizeQueue);
+			for (auto& request : pending)
+			{
+				if (request->IsCancelled())
+				{
+					Complete(request, EAssetStreamState::CANCELLED);
+					continue;
+				}
+
+				bool isReady{true};
+				bool isFailed{};
+				for (const auto& dependency : request->m_Dependencies)
+				{
+					const auto state = dependency->GetState();
+					if (state == EAssetStreamState::FAILED || state == EAssetStreamState::CANCELLED)
+						isFailed = true;
+					else if (state != EAssetStreamState::DONE)
+						isReady = false;
+				}
+
+				if (!isFailed && !isReady)
+				{
+					m_FinalizeQueue.emplace_back(std::move(request));
+					continue;
+				}
+
+				isProgress = true;
+				if (isFailed)
+				{
+					OE_CORE_WARN("Dependency of asset with '{}' hash failed to load!", request->m_Asset->GetAssetInfo()->GetHash());
+					Complete(request, EAssetStreamState::FAILED);
+					continue;
+				}
+
+				const auto finalizeStart = std::chrono::steady_clock::now();
+				const auto finalized = request->m_Provider->CompleteAsset(request->m_Asset.get());
+				request->m_Stats.finalize = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - finalizeStart).count();
+				Complete(request, finalized ? EAssetStreamState::DONE : EAssetStreamState::FAILED);
+			}
+		}
+	}
+
+	void AssetsStreamer::CancelAll()
+	{
+		for (const auto& request : m_Active)
+			request.second->Cancel();
+		for (const auto& request : m_Chained)
+			request.second->Cancel();
+	}
+
+	void AssetsStreamer::Flush()
+	{
+		while (!IsIdle())
+		{
+			Update();
+			JobManager::Poll();
+		}
+	}
+
+	void AssetsStreamer::Flush(const Ref<AssetStreamRequest>& request)
+	{
+		while (!request->IsDone())
+		{
+			Update();
+			JobManager::Poll();
+		}
+	}
+
+	void AssetsStreamer::SetMaxIOJobs(uint32_t count) noexcept
+	{
+		m_MaxIOJobs = std::max(1u, count);
+	}
+
+	void AssetsStreamer::SetMaxAsyncReads(uint32_t count) noexcept
+	{
+		m_MaxAsyncReads = std::max(1u, count);
+	}
+
+	void AssetsStreamer::SetMaxDecodeJobs(uint32_t count) noexcept
+	{
+		m_MaxDecodeJobs = std::max(1u, count);
+	}
+
+	bool AssetsStreamer::IsIdle() const noexcept
+	{
+		return m_Active.empty();
+	}
+
+	void AssetsStreamer::OnStageFinished(const Ref<AssetStreamRequest>& request, EAssetStreamState state)
+	{
+		request->m_State.store(state);
+		std::lock_guard lock(m_FinishedMutex);
+		m_Finished.emplace_back(request);
+	}
+
+	void AssetsStreamer::Complete(const Ref<AssetStreamRequest>& request, EAssetStreamState state)
+	{
+		request->m_State.store(state);
+		request->m_Data = {};
+		request->m_Dependencies.clear();
+
+		const auto* asset = request->m_Asset.get();
+		if (const auto& active = m_Active.find(asset); active != m_Active.end() && active->second == request)
+		{
+			m_Active.erase(active);
+
+			// The request that waited for this one starts now
+			if (const auto& chained = m_Chained.find(asset); chained != m_Chained.end())
+			{
+				m_Active[asset] = chained->second;
+				m_ReadQueue.emplace_back(std::move(chained->second));
+				m_Chained.erase(chained);
+			}
+		}
+
+		if (state == EAssetStreamState::CANCELLED)
+			return;
+
+		// Whatever was not spent in a stage was spent waiting, for a job slot, a dependency or the next update
+		auto& stats = request->m_Stats;
+		const auto total = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - request->m_RequestTime).count();
+		stats.queueWait = std::max(0.0f, total - stats.read - stats.decode - stats.finalize);
+		stats.isFailed = state == EAssetStreamState::FAILED;
+		request->m_Provider->RecordLoadStats(request->m_Asset.get(), stats);
+
+		if (state == EAssetStreamState::FAILED)
+			OE_CORE_WARN("Failed to stream asset with '{}' hash!", request->m_Asset->GetAssetInfo()->GetHash());
+
+		for (const auto& callback : request->m_Callbacks)
+			callback(request->m_Asset, state == EAssetStreamState::DONE);
+	}
+
+	bool AssetsStreamer::DispatchAsyncRead(const Ref<AssetStreamRequest>& request)
+	{
+		m_AsyncReads.fetch_add(1);
+		request->m_State.store(EAssetStreamState::READING);
+		const auto start = std::chrono::steady_clock::now();
+		const auto isQueued = request->m_Provider->ReadAssetAsync(request->m_Asset.get(), request->m_Data, [this, request, start](bool isRead) {
+			request->m_Stats.read = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+			request->m_Stats.diskSize = request->m_Data.size();
+			request->m_Stats.isAsyncRead = true;
+			OnStageFinished(request, isRead ? EAssetStreamState::READ : EAssetStreamState::FAILED);
+			m_AsyncReads.fetch_sub(1);
+		});
+
+		if (!isQueued)
+		{
+			request->m_State.store(EAssetStreamState::QUEUED);
+			m_AsyncReads.fetch_sub(1);
+		}
+		return isQueued;
+	}
+
+	void AssetsStreamer::Dispatch(std::vector<Ref<AssetStreamRequest>>& queue, std::atomic<uint32_t>& jobs, uint32_t maxJobs, bool decode)
+	{
+		if (queue.empty())
+			return;
+
+		// Completed after the queue is compacted, completing may queue a chained request
+		std::vector<Ref<AssetStreamRequest>> cancelled{};
+		std::erase_if(queue, [&cancelled](const auto& request) {
+			if (!request->IsCancelled())
+				return false;
+			cancelled.emplace_back(request);
+			return true;
+		});
+		for (const auto& request : cancelled)
+			Complete(request, EAssetStreamState::CANCELLED);
+
+		// Most urgent requests at the back, so they are popped without shifting the queue
+		std::sort(queue.begin(), queue.end(), [](const auto& left, const auto& right) {
+			return left->GetPriority() > right->GetPriority();
+		});
+
+		// Reads that can wait for the disk without a job go first, so a few slow jobs do not hold back the rest
+		if (!decode)
+		{
+			for (auto i = queue.size(); i-- > 0 && m_AsyncReads.load() < m_MaxAsyncReads;)
+			{
+				if (DispatchAsyncRead(queue[i]))
+					queue.erase(queue.begin() + static_cast<ptrdiff_t>(i));
+			}
+		}
+
+		while (!queue.empty() && jobs.load() < maxJobs)
+		{
+			auto request = queue.back();
+			jobs.fetch_add(1);
+			request->m_State.store(decode ? EAssetStreamState::DECODING : EAssetStreamState::READING);
+			// The main thread never waits for a job slot, a full pool leaves the rest queued for the next update
+			const auto isAdded = JobManager::TryAddTask([this, request, decode, &jobs] {
+				auto* asset = request->m_Asset.get();
+				bool result{};
+				if (!request->IsCancelled())
+				{
+					const auto start = std::chrono::steady_clock::now();
+					result = decode ? request->m_Provider->DecodeAsset(asset, request->m_Data)
+									: request->m_Provider->ReadAsset(asset, request->m_Data);
+
+					const auto time = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+					if (decode)
+						request->m_Stats.decode = time;
+					else
+					{
+						request->m_Stats.read = time;
+						request->m_Stats.diskSize = request->m_Data.size();
+					}
+				}
+
+				if (!result)
+					OnStageFinished(request, EAssetStreamState::FAILED);
+				else
+					OnStageFinished(request, decode ? EAssetStreamState::DECODED : EAssetStreamState::READ);
+				jobs.fetch_sub(1);
+			});
+			if (!isAdded)
+			{
+				request->m_State.store(decode ? EAssetStreamState::READ : EAssetStreamState::QUEUED);
+				jobs.fetch_sub(1);
+				break;
+			}
+			queue.pop_back();
+		}
+	}
+} // namespace oe
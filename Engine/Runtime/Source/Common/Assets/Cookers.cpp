@@ -0,0 +1,131 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#include "Oneiro/Common/Assets/Cookers.hpp"
+
+#include "Oneiro/Common/World/World.hpp"
+
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_NO_STDIO
+#include "stb_image.h"
+
+#include <cstring>
+
+namespace oe
+{
+	std::string WorldCooker::GetSettings() const
+	{
+		return World::GetCookedLayout();
+	}
+
+	bool WorldCooker::Cook(const FileSystem::Path&, std::span<const std::byte> source, std::vector<std::byte>& payload) const
+	{
+		return World::Cook({reinterpret_cast<const char*>(source.data()), source.size()}, payload);
+	}
+
+	bool TextureCooker::Cook(const FileSystem::Path& path, std::span<const std::byte> source, std::vector<std::byte>& payload) const
+	{
+		int width{};
+		int height{};
+		int channels{};
+		auto* pixels = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(source.data()), static_cast<int>(source.size()), &width,
+											 &height, &channels, STBI_rgb_alpha);
+		if (!pixels)
+		{
+			OE_CORE_ERROR("Failed to decode image '{}': {}", path.string(), stbi_failure_reason());
+			return false;
+		}
+
+		const CookedTexture texture{static_cast<uint32_t>(width), static_cast<uint32_t>(height), STBI_rgb_alpha};
+		const auto pixelsSize = static_cast<size_t>(width) * static_cast<size_t>(height) * STBI_rgb_alpha;
+		payload.resize(sizeof(texture) + pixelsSize);
+		std::memcpy(payload.data(), &texture, sizeof(texture));
+		std::memcpy(payload.data() + sizeof(texture), pixels, pixelsSize);
+		stbi_image_free(pixels);
+		return true;
+	}
+
+	bool ShaderCooker::Cook(const FileSystem::Path& path, std::span<const std::byte> source, std::vector<std::byte>& payload) const
+	{
+		CookedShader shader{};
+		const auto extension = path.extension();
+		if (extension == ".vert")
+			shader.stage = RHI::EShaderStage::VERTEX;
+		else if (extension == ".frag")
+			shader.stage = RHI::EShaderStage::FRAGMENT;
+		else
+		{
+			OE_CORE_ERROR("Unknown shader stage of '{}'!", path.string());
+			return false;
+		}
+
+		const std::string_view input{reinterpret_cast<const char*>(source.data()), source.size()};
+		std::string output{};
+		output.reserve(input.size());
+
+		bool isLineComment{};
+		bool isBlockComment{};
+		for (size_t i{}; i < input.size(); ++i)
+		{
+			const auto c = input[i];
+			const auto next = i + 1 < input.size() ? input[i + 1] : '\0';
+
+			if (c == '\r')
+				continue;
+
+			if (c == '\n')
+			{
+				// Trailing whitespace is dropped, newlines are kept even inside block comments so line numbers match
+				while (!output.empty() && (output.back() == ' ' || output.back() == '\t'))
+					output.pop_back();
+				output += '\n';
+				isLineComment = false;
+				continue;
+			}
+
+			if (isLineComment)
+				continue;
+
+			if (isBlockComment)
+			{
+				if (c == '*' && next == '/')
+				{
+					isBlockComment = false;
+					++i;
+				}
+				continue;
+			}
+
+			if (c == '/' && next == '/')
+			{
+				isLineComment = true;
+				continue;
+			}
+
+			if (c == '/' && next == '*')
+			{
+				isBlockComment = true;
+				output += ' ';
+				++i;
+				continue;
+			}
+
+			output += c;
+		}
+
+		const auto firstDirective = output.find_first_not_of(" \t\n");
+		if (firstDirective == std::string::npos || output.compare(firstDirective, 8, "#version") != 0)
+		{
+			OE_CORE_ERROR("Shader '{}' has to start with a #version directive!", path.string());
+			return false;
+		}
+
+		shader.sourceSize = static_cast<uint32_t>(output.size());
+		payload.resize(sizeof(shader) + output.size());
+		std::memcpy(payload.data(), &shader, sizeof(shader));
+		std::memcpy(payload.data() + sizeof(shader), output.data(), output.size());
+		return true;
+	}
+} // namespace oe
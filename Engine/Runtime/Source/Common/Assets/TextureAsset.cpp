@@ -0,0 +1,312 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#include "Oneiro/Common/Assets/TextureAsset.hpp"
+
+#include "Oneiro/Common/EngineApi.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <limits>
+
+namespace oe
+{
+	std::vector<std::byte> TextureStagingPool::Acquire(size_t size)
+	{
+		{
+			std::lock_guard lock(m_Mutex);
+
+			// Smallest buffer that fits, so large buffers stay available for large textures
+			auto best = m_Buffers.end();
+			for (auto buffer = m_Buffers.begin(); buffer != m_Buffers.end(); ++buffer)
+			{
+				if (buffer->capacity() >= size && (best == m_Buffers.end() || buffer->capacity() < best->capacity()))
+					best = buffer;
+			}
+
+			if (best != m_Buffers.end())
+			{
+				auto result = std::move(*best);
+				m_PooledBytes -= result.capacity();
+				*best = std::move(m_Buffers.back());
+				m_Buffers.pop_back();
+				result.resize(size);
+				return result;
+			}
+		}
+
+		return std::vector<std::byte>(size);
+	}
+
+	void TextureStagingPool::Release(std::vector<std::byte>&& buffer)
+	{
+		std::lock_guard lock(m_Mutex);
+		if (buffer.capacity() == 0 || m_PooledBytes + buffer.capacity() > m_MaxPooledBytes)
+			return;
+
+		m_PooledBytes += buffer.capacity();
+		m_Buffers.emplace_back(std::move(buffer));
+	}
+
+	void TextureStagingPool::SetMaxPooledBytes(size_t bytes) noexcept
+	{
+		std::lock_guard lock(m_Mutex);
+		m_MaxPooledBytes = bytes;
+		while (m_PooledBytes > m_MaxPooledBytes && !m_Buffers.empty())
+		{
+			m_PooledBytes -= m_Buffers.back().capacity();
+			m_Buffers.pop_back();
+		}
+	}
+
+	bool TextureAsset::IsLoaded() const noexcept
+	{
+		return nativePtr.load(std::memory_order_acquire) != nullptr;
+	}
+
+	RHI::ITexture* TextureAsset::GetTexture() const noexcept
+	{
+		return IsLoaded() ? m_Texture.get() : m_Provider->GetPlaceholder();
+	}
+
+	TextureAssetsProvider::TextureAssetsProvider()
+	{
+		CreatePlaceholder();
+	}
+
+	Ref<IAsset> TextureAssetsProvider::CreateAsset(const Ref<AssetInfo>& assetInfo)
+	{
+		auto asset = CreateRef<TextureAsset>(assetInfo, nullptr, GetTypeId<RHI::ITexture>());
+		asset->m_Provider = this;
+		return asset;
+	}
+
+	bool TextureAssetsProvider::ReadAsset(IAsset* asset, std::string& data)
+	{
+		const auto& assetData = asset->GetAssetInfo()->template GetData<FileSystem::Path>();
+		if (!assetData)
+			return false;
+
+		const auto& path = get<0>(*assetData);
+		if (!EngineApi::GetAssetsManager()->GetCooker()->ReadCooked(path, ECookedAssetType::TEXTURE, data))
+			return false;
+
+		if (data.empty())
+		{
+			OE_CORE_ERROR("Texture '{}' not found!", path.string());
+			return false;
+		}
+		return true;
+	}
+
+	bool TextureAssetsProvider::ReadAssetAsync(IAsset* asset, std::string& data, FileSystem::ReadCallback callback)
+	{
+		const auto& assetData = asset->GetAssetInfo()->template GetData<FileSystem::Path>();
+		if (!assetData)
+			return false;
+
+		const auto& path = get<0>(*assetData);
+		return EngineApi::GetAssetsManager()->GetCooker()->ReadCookedAsync(
+			path, ECookedAssetType::TEXTURE, data, [path, &data, callback = std::move(callback)](bool isRead) {
+				if (isRead && data.empty())
+				{
+					OE_CORE_ERROR("Texture '{}' not found!", path.string());
+					isRead = false;
+				}
+				callback(isRead);
+			});
+	}
+
+	bool TextureAssetsProvider::DecodeAsset(IAsset* asset, std::string& data)
+	{
+		// Decoded into separate members, an earlier load of the same asset may still be uploading from its staging
+		auto* textureAsset = static_cast<TextureAsset*>(asset);
+		auto& header = textureAsset->m_DecodedHeader;
+		if (data.size() < sizeof(header))
+			return false;
+
+		std::memcpy(&header, data.data(), sizeof(header));
+		const auto pixelsSize = static_cast<size_t>(header.width) * header.height * 4;
+		if (header.channels != 4 || header.width == 0 || header.height == 0 || data.size() - sizeof(header) != pixelsSize)
+		{
+			OE_CORE_ERROR("Texture with '{}' hash has invalid cooked data!", asset->GetAssetInfo()->GetHash());
+			return false;
+		}
+
+		textureAsset->m_DecodedPixels = m_StagingPool.Acquire(pixelsSize);
+		std::memcpy(textureAsset->m_DecodedPixels.data(), data.data() + sizeof(header), pixelsSize);
+		return true;
+	}
+
+	bool TextureAssetsProvider::FinalizeAsset(IAsset* asset)
+	{
+		auto* rhi = EngineApi::GetRHI();
+		auto* textureAsset = static_cast<TextureAsset*>(asset);
+		if (textureAsset->m_DecodedPixels.empty())
+			return false;
+
+		if (!rhi)
+		{
+			OE_CORE_ERROR("Textures can't be loaded without a RHI!");
+			m_StagingPool.Release(std::move(textureAsset->m_DecodedPixels));
+			textureAsset->m_DecodedPixels = {};
+			return false;
+		}
+
+		m_StagingPool.Release(std::move(textureAsset->m_Staging));
+		textureAsset->m_Staging = std::move(textureAsset->m_DecodedPixels);
+		textureAsset->m_DecodedPixels = {};
+		textureAsset->m_Header = textureAsset->m_DecodedHeader;
+		const auto& header = textureAsset->m_Header;
+
+		RHI::TextureCreateInfo createInfo{};
+		createInfo.imageType = RHI::ImageType::TEX_2D;
+		createInfo.format = RHI::Format::R8G8B8A8_UNORM;
+		createInfo.extent = {header.width, header.height, 1};
+		createInfo.mipLevels = static_cast<uint32_t>(std::bit_width(std::max(header.width, header.height)));
+		createInfo.arrayLayers = 1;
+		createInfo.sampleCount = RHI::SampleCount::SAMPLES_1;
+
+		// Only the storage is allocated here, the pixels are uploaded over the next frames and the placeholder stays
+		// bound until then
+		textureAsset->nativePtr = nullptr;
+		textureAsset->m_Texture = rhi->CreateTexture(createInfo);
+		textureAsset->m_UploadedRows = 0;
+		if (textureAsset->m_IsUploading)
+			return true;
+
+		textureAsset->m_IsUploading = true;
+		if (auto cached = FindAsset(asset->GetAssetInfo()->GetHash()); cached.get() == asset)
+		{
+			m_Uploads.emplace_back(std::move(cached));
+			return true;
+		}
+
+		// Assets that were never cached can't be kept alive by the queue
+		auto budget = std::numeric_limits<size_t>::max();
+		Upload(textureAsset, budget);
+		return true;
+	}
+
+	AssetMemoryUsage TextureAssetsProvider::MeasureAsset(const IAsset* asset) const
+	{
+		const auto* textureAsset = static_cast<const TextureAsset*>(asset);
+		const auto& header = textureAsset->m_Header;
+
+		// The mip chain adds a third of the base level
+		const auto baseSize = static_cast<size_t>(header.width) * header.height * 4;
+		return {textureAsset->m_Staging.capacity(), baseSize + baseSize / 3};
+	}
+
+	bool TextureAssetsProvider::UnloadAsset(IAsset* asset)
+	{
+		auto* textureAsset = static_cast<TextureAsset*>(asset);
+		if (textureAsset->m_IsUploading)
+			return false;
+
+		textureAsset->nativePtr = nullptr;
+		textureAsset->m_Texture.reset();
+		return true;
+	}
+
+	void TextureAssetsProvider::Update()
+	{
+		// Providers registered before the RHI get their placeholder on the first frame
+		if (!m_Placeholder)
+			CreatePlaceholder();
+
+		// At least one row is uploaded every frame, so a texture wider than the budget still makes progress
+		auto budget = m_UploadBudget;
+		while (!m_Uploads.empty() && budget > 0)
+		{
+			if (!Upload(static_cast<TextureAsset*>(m_Uploads.front().get()), budget))
+				break;
+			m_Uploads.pop_front();
+		}
+	}
+
+	void TextureAssetsProvider::Flush()
+	{
+		for (const auto& asset : m_Uploads)
+		{
+			auto budget = std::numeric_limits<size_t>::max();
+			Upload(static_cast<TextureAsset*>(asset.get()), budget);
+		}
+		m_Uploads.clear();
+	}
+
+	void TextureAssetsProvider::Shutdown()
+	{
+		m_Uploads.clear();
+		m_Placeholder.reset();
+	}
+
+	bool TextureAssetsProvider::Upload(TextureAsset* asset, size_t& budget)
+	{
+		const auto& header = asset->m_Header;
+		if (!asset->m_Texture || asset->m_Staging.empty())
+		{
+			asset->m_IsUploading = false;
+			return true;
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+		const auto rowSize = static_cast<size_t>(header.width) * 4;
+		const auto remainingRows = header.height - asset->m_UploadedRows;
+		const auto rows = static_cast<uint32_t>(std::clamp<size_t>(budget / rowSize, 1, remainingRows));
+
+		RHI::TextureUpdateInfo updateInfo{};
+		updateInfo.offset = {0, asset->m_UploadedRows, 0};
+		updateInfo.extent = {header.width, rows, 1};
+		updateInfo.format = RHI::UploadFormat::RGBA;
+		updateInfo.type = RHI::UploadType::UBYTE;
+		updateInfo.pixels = asset->m_Staging.data() + asset->m_UploadedRows * rowSize;
+		asset->m_Texture->UpdateImage(updateInfo);
+
+		asset->m_UploadedRows += rows;
+		budget -= std::min(budget, rows * rowSize);
+		AddUploadTime(asset, std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count());
+		if (asset->m_UploadedRows < header.height)
+			return false;
+
+		asset->m_Texture->GenMipmaps();
+		asset->nativePtr.store(asset->m_Texture.get(), std::memory_order_release);
+		asset->m_IsUploading = false;
+
+		// The staging memory goes back to the pool and no longer counts against the CPU budget
+		m_StagingPool.Release(std::move(asset->m_Staging));
+		asset->m_Staging = {};
+		RemeasureAsset(asset);
+		return true;
+	}
+
+	void TextureAssetsProvider::CreatePlaceholder()
+	{
+		auto* rhi = EngineApi::GetRHI();
+		if (!rhi)
+			return;
+
+		// Magenta and black checker, obvious when a texture stays missing
+		static constexpr uint32_t Pixels[] = {0xFFFF00FF, 0xFF000000, 0xFF000000, 0xFFFF00FF};
+
+		RHI::TextureCreateInfo createInfo{};
+		createInfo.imageType = RHI::ImageType::TEX_2D;
+		createInfo.format = RHI::Format::R8G8B8A8_UNORM;
+		createInfo.extent = {2, 2, 1};
+		createInfo.mipLevels = 1;
+		createInfo.arrayLayers = 1;
+		createInfo.sampleCount = RHI::SampleCount::SAMPLES_1;
+		m_Placeholder = rhi->CreateTexture(createInfo, "Placeholder");
+
+		RHI::TextureUpdateInfo updateInfo{};
+		updateInfo.extent = {2, 2, 1};
+		updateInfo.format = RHI::UploadFormat::RGBA;
+		updateInfo.type = RHI::UploadType::UBYTE;
+		updateInfo.pixels = Pixels;
+		m_Placeholder->UpdateImage(updateInfo);
+	}
+} // namespace oe
@@ -7,51 +7,63 @@
 
 bool oe::WorldAsset::IsLoaded() const noexcept
 {
-	return nativePtr != nullptr;
+	return nativePtr.load(std::memory_order_acquire) != nullptr;
 }
 
 oe::Ref<oe::IAsset> oe::WorldAssetsProvider::CreateAsset(const Ref<AssetInfo>& assetInfo)
 {
-	return CreateRef<WorldAsset>(assetInfo, nullptr, typeid(World).hash_code());
+	return CreateRef<WorldAsset>(assetInfo, nullptr, GetTypeId<World>());
 }
 
-void oe::WorldAssetsProvider::LoadAsset(const Ref<IAsset>& asset, bool async)
+bool oe::WorldAssetsProvider::ReadAsset(IAsset* asset, std::string& data)
 {
-	if (async)
-	{
-		mAssets2Load.emplace_back(asset.get());
-		return;
-	}
-	const auto& assetInfo = asset->GetAssetInfo();
-	const auto& assetData = assetInfo->template GetData<FileSystem::Path>();
-	const auto& path = get<0>(*assetData);
-	asset->nativePtr = EngineApi::GetWorldManager()->LoadWorld(path);
-	if (!asset->nativePtr)
-		OE_CORE_WARN("Failed to load world from '{}' asset hash!", assetInfo->GetHash());
+	const auto& assetData = asset->GetAssetInfo()->template GetData<FileSystem::Path>();
+	if (!assetData)
+		return false;
+
+	// A missing world file is a new, empty world
+	return EngineApi::GetAssetsManager()->GetCooker()->ReadCooked(get<0>(*assetData), ECookedAssetType::WORLD, data,
+																   static_cast<WorldAsset*>(asset)->m_IsSource);
+}
+
+bool oe::WorldAssetsProvider::ReadAssetAsync(IAsset* asset, std::string& data, FileSystem::ReadCallback callback)
+{
+	const auto& assetData = asset->GetAssetInfo()->template GetData<FileSystem::Path>();
+	if (!assetData)
+		return false;
+
+	return EngineApi::GetAssetsManager()->GetCooker()->ReadCookedAsync(get<0>(*assetData), ECookedAssetType::WORLD, data,
+																		std::move(callback), &static_cast<WorldAsset*>(asset)->m_IsSource);
 }
 
-void oe::WorldAssetsProvider::LoadAssetsAsync()
+bool oe::WorldAssetsProvider::DecodeAsset(IAsset* asset, std::string& data)
 {
-	if (mAssets2Load.empty())
-		return;
-
-	std::vector<std::future<void>> futures{};
-
-	std::for_each(std::execution::par, mAssets2Load.begin(), mAssets2Load.end(), [&](const auto& item) {
-		futures.emplace_back(std::async(std::launch::async, [&]() {
-			const auto& assetInfo = item->GetAssetInfo();
-			const auto& assetData = assetInfo->template GetData<FileSystem::Path>();
-			const auto& path = get<0>(*assetData);
-			item->nativePtr = EngineApi::GetWorldManager()->LoadWorld(path);
-			if (!item->nativePtr)
-				OE_CORE_WARN("Failed to load world from '{}' asset hash!", assetInfo->GetHash());
-		}));
-	});
-
-	for (size_t i{}; i < futures.size(); i++)
+	const auto& assetInfo = asset->GetAssetInfo();
+	const auto& path = get<0>(*assetInfo->template GetData<FileSystem::Path>());
+
+	auto world = CreateRef<World>();
+	// Worlds read from cooked files have no source to be saved to
+	const auto sourcePath = static_cast<WorldAsset*>(asset)->m_IsSource ? path : FileSystem::Path{};
+	if (!world->LoadCooked(path, std::as_bytes(std::span{data}), sourcePath))
 	{
-		futures[i].wait();
+		OE_CORE_WARN("Failed to load world from '{}' asset hash!", assetInfo->GetHash());
+		return false;
 	}
 
-	mAssets2Load.clear();
+	static_cast<WorldAsset*>(asset)->m_DecodedWorld = std::move(world);
+	return true;
+}
+
+bool oe::WorldAssetsProvider::FinalizeAsset(IAsset* asset)
+{
+	auto* worldAsset = static_cast<WorldAsset*>(asset);
+	if (!worldAsset->m_DecodedWorld)
+		return false;
+
+	auto* worldManager = EngineApi::GetWorldManager();
+	auto* world = worldManager->AddWorld(worldAsset->m_DecodedWorld);
+	worldManager->SetWorld(world);
+	asset->nativePtr.store(world, std::memory_order_release);
+	worldAsset->m_DecodedWorld.reset();
+	return true;
 }
@@ -16,7 +16,6 @@ namespace oe
 		{
 			moduleManager.reset();
 			cVars.reset();
-			ecs.reset();
 			worldManager.reset();
 			assetsManager.reset();
 		}
@@ -29,7 +28,6 @@ namespace oe
 		m_Instance->application = application;
 		m_Instance->moduleManager = CreateRef<ModuleManager>();
 		m_Instance->cVars = CreateRef<CVars>();
-		m_Instance->ecs = CreateRef<flecs::world>();
 		m_Instance->worldManager = CreateRef<WorldManager>();
 		m_Instance->assetsManager = CreateRef<AssetsManager>();
 		return true;
@@ -0,0 +1,481 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#include "Oneiro/Common/FileSystem/Archive.hpp"
+
+#include "Oneiro/Common/Common.hpp"
+#include "Oneiro/Common/FileSystem/FileSystem.hpp"
+#include "Oneiro/Common/JobManager.hpp"
+
+#include "lz4.h"
+#include "lz4hc.h"
+#include "xxhash.h"
+#include "zstd.h"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+#include <memory>
+
+namespace oe::FileSystem
+{
+	namespace
+	{
+		constexpr uint64_t AlignOffset(uint64_t offset, uint64_t alignment) noexcept
+		{
+			return (offset + alignment - 1) / alignment * alignment;
+		}
+
+		// Compression runs offline, so spend the time on the ratio, decode speed barely depends on the level
+		constexpr int LZ4CompressionLevel = LZ4HC_CLEVEL_DEFAULT;
+		constexpr int ZSTDCompressionLevel = 19;
+
+		// Returns the compressed size, or 0 when the codec failed
+		size_t CompressBlock(EArchiveCodec codec, std::span<const std::byte> source, std::vector<std::byte>& destination)
+		{
+			switch (codec)
+			{
+				case EArchiveCodec::LZ4: {
+					destination.resize(static_cast<size_t>(LZ4_compressBound(static_cast<int>(source.size()))));
+					const auto size = LZ4_compress_HC(reinterpret_cast<const char*>(source.data()), reinterpret_cast<char*>(destination.data()),
+													  static_cast<int>(source.size()), static_cast<int>(destination.size()), LZ4CompressionLevel);
+					return size > 0 ? static_cast<size_t>(size) : 0;
+				}
+				case EArchiveCodec::ZSTD: {
+					destination.resize(ZSTD_compressBound(source.size()));
+					const auto size = ZSTD_compress(destination.data(), destination.size(), source.data(), source.size(), ZSTDCompressionLevel);
+					return ZSTD_isError(size) ? 0 : size;
+				}
+				default: return 0;
+			}
+		}
+
+		bool DecodeBlock(EArchiveCodec codec, std::span<const std::byte> source, std::span<std::byte> destination) noexcept
+		{
+			// Blocks that did not shrink are stored as is
+			if (source.size() == destination.size())
+			{
+				std::memcpy(destination.data(), source.data(), source.size());
+				return true;
+			}
+
+			switch (codec)
+			{
+				case EArchiveCodec::LZ4: {
+					const auto size = LZ4_decompress_safe(reinterpret_cast<const char*>(source.data()), reinterpret_cast<char*>(destination.data()),
+														  static_cast<int>(source.size()), static_cast<int>(destination.size()));
+					return size == static_cast<int>(destination.size());
+				}
+				case EArchiveCodec::ZSTD: {
+					thread_local std::unique_ptr<ZSTD_DCtx, decltype(&ZSTD_freeDCtx)> context{ZSTD_createDCtx(), &ZSTD_freeDCtx};
+					const auto size = ZSTD_decompressDCtx(context.get(), destination.data(), destination.size(), source.data(), source.size());
+					return !ZSTD_isError(size) && size == destination.size();
+				}
+				default: return false;
+			}
+		}
+	} // namespace
+
+	Archive::~Archive()
+	{
+		Close();
+	}
+
+	bool Archive::Open(const Path& path)
+	{
+		Close();
+
+		if (!m_File.Open(path, EMapAccess::RANDOM))
+		{
+			OE_CORE_ERROR("Failed to map archive '{}'!", path.string());
+			return false;
+		}
+
+		const auto* data = m_File.GetData().data();
+		const auto size = m_File.GetSize();
+
+		ArchiveHeader header{};
+		if (size >= sizeof(header))
+			std::memcpy(&header, data, sizeof(header));
+
+		const auto indexEnd = sizeof(header) + static_cast<uint64_t>(header.entriesCount) * sizeof(ArchiveEntry);
+		if (size < sizeof(header) || header.magic != ArchiveHeader::Magic || header.version != ArchiveHeader::CurrentVersion ||
+			indexEnd > size || header.namesOffset < indexEnd || header.namesOffset + header.namesSize > size)
+		{
+			OE_CORE_ERROR("Archive '{}' is corrupted or has unsupported version!", path.string());
+			Close();
+			return false;
+		}
+
+		m_Entries = {reinterpret_cast<const ArchiveEntry*>(data + sizeof(header)), header.entriesCount};
+		m_Names = {reinterpret_cast<const char*>(data + header.namesOffset), static_cast<size_t>(header.namesSize)};
+
+		// Validated once here, so lookups can trust the index without bounds checks
+		const auto isSorted = std::is_sorted(m_Entries.begin(), m_Entries.end(),
+											 [](const auto& left, const auto& right) { return left.hash < right.hash; });
+		const auto isInBounds = std::all_of(m_Entries.begin(), m_Entries.end(), [this, size](const ArchiveEntry& entry) {
+			const auto isDataValid = entry.codec == EArchiveCodec::NONE
+										 ? entry.size == entry.uncompressedSize
+										 : entry.codec <= EArchiveCodec::ZSTD && entry.blockSize != 0 &&
+											   (entry.GetBlocksCount() + 1) * sizeof(uint64_t) <= entry.size;
+			return isDataValid && entry.offset <= size && entry.size <= size - entry.offset &&
+				   static_cast<uint64_t>(entry.nameOffset) + entry.nameSize <= m_Names.size();
+		});
+		if (!isSorted || !isInBounds)
+		{
+			OE_CORE_ERROR("Archive '{}' has corrupted index!", path.string());
+			Close();
+			return false;
+		}
+		return true;
+	}
+
+	void Archive::Close() noexcept
+	{
+		m_File.Close();
+		m_Entries = {};
+		m_Names = {};
+	}
+
+	const ArchiveEntry* Archive::GetEntry(std::string_view path) const noexcept
+	{
+		const auto hash = HashPath(path);
+		const auto& entry = std::lower_bound(m_Entries.begin(), m_Entries.end(), hash,
+											 [](const ArchiveEntry& entry, uint64_t hash) { return entry.hash < hash; });
+		if (entry == m_Entries.end() || entry->hash != hash)
+			return nullptr;
+		return &*entry;
+	}
+
+	bool Archive::Contains(std::string_view path) const noexcept
+	{
+		return GetEntry(path) != nullptr;
+	}
+
+	std::span<const std::byte> Archive::Read(std::string_view path) const noexcept
+	{
+		const auto* entry = GetEntry(path);
+		if (!entry)
+			return {};
+		return Read(*entry);
+	}
+
+	std::span<const std::byte> Archive::Read(const ArchiveEntry& entry) const noexcept
+	{
+		if (entry.codec != EArchiveCodec::NONE)
+			return {};
+		return GetEntryData(entry);
+	}
+
+	bool Archive::Extract(const ArchiveEntry& entry, std::span<std::byte> destination) const
+	{
+		if (destination.size() < entry.uncompressedSize)
+			return false;
+
+		const auto data = GetEntryData(entry);
+		if (entry.codec == EArchiveCodec::NONE)
+		{
+			std::memcpy(destination.data(), data.data(), data.size());
+			return true;
+		}
+
+		std::atomic<bool> isFailed{};
+		const auto decodeBlock = [this, &entry, &isFailed, destination](size_t block) {
+			const auto begin = block * entry.blockSize;
+			if (!DecodeEntryBlock(entry, block, destination.subspan(begin)))
+				isFailed.store(true);
+		};
+
+		const auto blocksCount = static_cast<size_t>(entry.GetBlocksCount());
+		if (blocksCount == 1)
+			decodeBlock(0);
+		else
+			JobManager::ParallelFor(blocksCount, decodeBlock);
+
+		if (isFailed.load())
+			OE_CORE_ERROR("Failed to decompress archive entry '{}'!", GetEntryName(entry));
+		return !isFailed.load();
+	}
+
+	bool Archive::ExtractBlock(const ArchiveEntry& entry, uint64_t block, std::span<std::byte> destination) const
+	{
+		if (block >= entry.GetBlocksCount())
+			return false;
+
+		if (entry.codec == EArchiveCodec::NONE)
+		{
+			const auto data = GetEntryData(entry);
+			if (destination.size() < data.size())
+				return false;
+			std::memcpy(destination.data(), data.data(), data.size());
+			return true;
+		}
+
+		if (!DecodeEntryBlock(entry, block, destination))
+		{
+			OE_CORE_ERROR("Failed to decompress block {} of archive entry '{}'!", block, GetEntryName(entry));
+			return false;
+		}
+		return true;
+	}
+
+	uint64_t Archive::HashPath(std::string_view path) noexcept
+	{
+		// Paths coming from the engine are usually normalized already, hash them without a temporary
+		if (path.find('\\') == std::string_view::npos && !path.starts_with('/') && !path.starts_with("./"))
+			return XXH3_64bits(path.data(), path.size());
+
+		const auto normalized = NormalizePath(path);
+		return XXH3_64bits(normalized.data(), normalized.size());
+	}
+
+	std::string Archive::NormalizePath(std::string_view path)
+	{
+		std::string normalized{path};
+		std::replace(normalized.begin(), normalized.end(), '\\', '/');
+
+		size_t start{};
+		while (start < normalized.size())
+		{
+			if (normalized[start] == '/')
+				++start;
+			else if (normalized.compare(start, 2, "./") == 0)
+				start += 2;
+			else
+				break;
+		}
+		return normalized.erase(0, start);
+	}
+
+	std::string_view Archive::GetEntryName(const ArchiveEntry& entry) const noexcept
+	{
+		return m_Names.substr(entry.nameOffset, entry.nameSize);
+	}
+
+	bool Archive::DecodeEntryBlock(const ArchiveEntry& entry, uint64_t block, std::span<std::byte> destination) const noexcept
+	{
+		const auto data = GetEntryData(entry);
+
+		// The block table is not necessarily 8 byte aligned
+		uint64_t range[2]{};
+		std::memcpy(range, data.data() + block * sizeof(uint64_t), sizeof(range));
+
+		const auto size = std::min<uint64_t>(entry.blockSize, entry.uncompressedSize - block * entry.blockSize);
+		return destination.size() >= size && range[0] <= range[1] && range[1] <= data.size() &&
+			   DecodeBlock(entry.codec, data.subspan(range[0], range[1] - range[0]), destination.first(size));
+	}
+
+	std::span<const std::byte> Archive::GetEntryData(const ArchiveEntry& entry) const noexcept
+	{
+		return {m_File.GetData().data() + entry.offset, static_cast<size_t>(entry.size)};
+	}
+
+	ArchiveWriter::ArchiveWriter(uint32_t alignment, uint32_t blockSize)
+		: m_Alignment(std::bit_ceil(std::clamp(alignment, 1u, MaxAlignment))), m_BlockSize(std::max(blockSize, 4096u))
+	{
+	}
+
+	bool ArchiveWriter::AddFile(std::string_view path, std::span<const std::byte> data, EArchiveCodec codec)
+	{
+		auto normalized = Archive::NormalizePath(path);
+		const auto hash = XXH3_64bits(normalized.data(), normalized.size());
+
+		const auto& [existing, isInserted] = m_Hashes.emplace(hash, m_Entries.size());
+		if (!isInserted)
+		{
+			const auto& existingPath = m_Entries[existing->second].path;
+			if (existingPath == normalized)
+				OE_CORE_ERROR("File '{}' is already added to archive!", normalized);
+			else
+				OE_CORE_ERROR("Archive path hash collision between '{}' and '{}'!", existingPath, normalized);
+			return false;
+		}
+
+		Entry entry{hash, std::move(normalized)};
+		entry.codec = codec;
+		if (!Compress(entry, data))
+		{
+			m_Hashes.erase(hash);
+			return false;
+		}
+
+		m_Entries.emplace_back(std::move(entry));
+		return true;
+	}
+
+	bool ArchiveWriter::AddFile(std::string_view path, const Path& sourcePath, EArchiveCodec codec)
+	{
+		std::ifstream file(sourcePath, std::ios::binary | std::ios::ate);
+		if (!file)
+		{
+			OE_CORE_ERROR("Failed to open '{}' for archiving!", sourcePath.string());
+			return false;
+		}
+
+		std::vector<std::byte> data(static_cast<size_t>(file.tellg()));
+		file.seekg(0);
+		file.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+		return AddFile(path, data, codec);
+	}
+
+	bool ArchiveWriter::AddDirectory(const Path& directory, std::string_view mountPoint, const CodecSelector& selector)
+	{
+		std::error_code error{};
+		for (const auto& file : std::filesystem::recursive_directory_iterator(directory, error))
+		{
+			if (!file.is_regular_file())
+				continue;
+
+			auto path = std::string{mountPoint};
+			if (!path.empty() && path.back() != '/')
+				path += '/';
+			path += std::filesystem::relative(file.path(), directory).generic_string();
+			const auto codec = selector ? selector(Path{file.path()}, file.file_size()) : EArchiveCodec::NONE;
+			if (!AddFile(path, Path{file.path()}, codec))
+				return false;
+		}
+
+		if (error)
+			OE_CORE_ERROR("Failed to iterate '{}': {}", directory.string(), error.message());
+		return !error;
+	}
+
+	bool ArchiveWriter::Save(const Path& path)
+	{
+		std::sort(m_Entries.begin(), m_Entries.end(), [](const auto& left, const auto& right) { return left.hash < right.hash; });
+		for (size_t i{}; i < m_Entries.size(); ++i)
+			m_Hashes[m_Entries[i].hash] = i;
+
+		ArchiveHeader header{};
+		header.entriesCount = static_cast<uint32_t>(m_Entries.size());
+		header.alignment = m_Alignment;
+		header.namesOffset = sizeof(header) + m_Entries.size() * sizeof(ArchiveEntry);
+
+		std::vector<ArchiveEntry> index{};
+		index.reserve(m_Entries.size());
+		std::string names{};
+		for (const auto& entry : m_Entries)
+		{
+			ArchiveEntry& indexEntry = index.emplace_back();
+			indexEntry.hash = entry.hash;
+			indexEntry.size = entry.data.size();
+			indexEntry.uncompressedSize = entry.uncompressedSize;
+			indexEntry.nameOffset = static_cast<uint32_t>(names.size());
+			indexEntry.nameSize = static_cast<uint32_t>(entry.path.size());
+			indexEntry.blockSize = entry.codec == EArchiveCodec::NONE ? 0 : m_BlockSize;
+			indexEntry.codec = entry.codec;
+			names += entry.path;
+		}
+		header.namesSize = names.size();
+
+		auto offset = header.namesOffset + header.namesSize;
+		for (auto& entry : index)
+		{
+			entry.offset = AlignOffset(offset, m_Alignment);
+			offset = entry.offset + entry.size;
+		}
+
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		if (!file)
+		{
+			OE_CORE_ERROR("Failed to create archive '{}'!", path.string());
+			return false;
+		}
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(index.data()), static_cast<std::streamsize>(index.size() * sizeof(ArchiveEntry)));
+		file.write(names.data(), static_cast<std::streamsize>(names.size()));
+
+		static constexpr char padding[MaxAlignment]{};
+		offset = header.namesOffset + header.namesSize;
+		for (size_t i{}; i < m_Entries.size(); ++i)
+		{
+			file.write(padding, static_cast<std::streamsize>(index[i].offset - offset));
+			file.write(reinterpret_cast<const char*>(m_Entries[i].data.data()), static_cast<std::streamsize>(m_Entries[i].data.size()));
+			offset = index[i].offset + index[i].size;
+		}
+
+		file.close();
+		if (!file)
+		{
+			OE_CORE_ERROR("Failed to write archive '{}'!", path.string());
+			return false;
+		}
+
+		// Written around FileSystem, so the index learns about the archive here
+		FileSystem::RefreshIndex(path);
+		return true;
+	}
+
+	void ArchiveWriter::LogStats() const
+	{
+		constexpr double MiB = 1024.0 * 1024.0;
+		for (const auto& [type, stats] : m_Stats)
+		{
+			const auto ratio = stats.storedSize ? static_cast<double>(stats.uncompressedSize) / static_cast<double>(stats.storedSize) : 1.0;
+			if (stats.decodeSeconds > 0.0)
+			{
+				OE_CORE_INFO("'{}': {} entries, {:.2f} MiB -> {:.2f} MiB, ratio {:.2f}, decode {:.1f} MiB/s", type, stats.entriesCount,
+							 stats.uncompressedSize / MiB, stats.storedSize / MiB, ratio, stats.uncompressedSize / MiB / stats.decodeSeconds);
+			}
+			else
+			{
+				OE_CORE_INFO("'{}': {} entries, {:.2f} MiB stored uncompressed", type, stats.entriesCount, stats.uncompressedSize / MiB);
+			}
+		}
+	}
+
+	bool ArchiveWriter::Compress(Entry& entry, std::span<const std::byte> data)
+	{
+		entry.uncompressedSize = data.size();
+		if (data.empty())
+			entry.codec = EArchiveCodec::NONE;
+
+		auto extension = Path{entry.path}.extension().string();
+		auto& stats = m_Stats[extension.empty() ? "<none>" : extension];
+		++stats.entriesCount;
+		stats.uncompressedSize += data.size();
+
+		if (entry.codec == EArchiveCodec::NONE)
+		{
+			entry.data.assign(data.begin(), data.end());
+			stats.storedSize += data.size();
+			return true;
+		}
+
+		const auto blocksCount = (data.size() + m_BlockSize - 1) / m_BlockSize;
+		std::vector<uint64_t> offsets(blocksCount + 1);
+		offsets[0] = offsets.size() * sizeof(uint64_t);
+		entry.data.resize(offsets[0]);
+
+		std::vector<std::byte> compressed{};
+		std::vector<std::byte> decoded(m_BlockSize);
+		for (size_t block{}; block < blocksCount; ++block)
+		{
+			const auto source = data.subspan(block * m_BlockSize, std::min<size_t>(m_BlockSize, data.size() - block * m_BlockSize));
+			const auto size = CompressBlock(entry.codec, source, compressed);
+			const auto stored = size && size < source.size() ? std::span<const std::byte>{compressed.data(), size} : source;
+
+			const auto start = std::chrono::steady_clock::now();
+			const auto isDecoded = DecodeBlock(entry.codec, stored, {decoded.data(), source.size()});
+			stats.decodeSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			if (!isDecoded || std::memcmp(decoded.data(), source.data(), source.size()) != 0)
+			{
+				OE_CORE_ERROR("Failed to compress '{}', block {} does not round trip!", entry.path, block);
+				return false;
+			}
+
+			entry.data.insert(entry.data.end(), stored.begin(), stored.end());
+			offsets[block + 1] = entry.data.size();
+		}
+
+		std::memcpy(entry.data.data(), offsets.data(), offsets[0]);
+		stats.storedSize += entry.data.size();
+		return true;
+	}
+} // namespace oe::FileSystem
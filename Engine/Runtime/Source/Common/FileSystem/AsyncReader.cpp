@@ -0,0 +1,510 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#include "Oneiro/Common/FileSystem/AsyncReader.hpp"
+
+#include "Oneiro/Common/Common.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <unordered_set>
+#include <utility>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#define OE_IO_URING 1
+#include <linux/io_uring.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+#ifdef _WIN32
+#include <cstdio>
+#else
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace oe::FileSystem
+{
+	namespace
+	{
+		// Blocking read of a whole file, the thread pool fallback
+		bool ReadFileBlocking(const std::string& path, std::string& dest)
+		{
+#ifdef _WIN32
+			auto* file = std::fopen(path.c_str(), "rb");
+			if (!file)
+				return false;
+
+			std::fseek(file, 0, SEEK_END);
+			dest.resize(static_cast<size_t>(std::ftell(file)));
+			std::fseek(file, 0, SEEK_SET);
+			const auto isRead = std::fread(dest.data(), 1, dest.size(), file) == dest.size();
+			std::fclose(file);
+			return isRead;
+#else
+			const auto fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+			if (fd < 0)
+				return false;
+
+			struct stat status{};
+			if (fstat(fd, &status) != 0)
+			{
+				close(fd);
+				return false;
+			}
+
+			dest.resize(static_cast<size_t>(status.st_size));
+			size_t offset{};
+			while (offset < dest.size())
+			{
+				const auto result = pread(fd, dest.data() + offset, dest.size() - offset, static_cast<off_t>(offset));
+				if (result <= 0)
+					break;
+				offset += static_cast<size_t>(result);
+			}
+			close(fd);
+			return offset == dest.size();
+#endif
+		}
+	} // namespace
+
+#ifdef OE_IO_URING
+	// Raw io_uring without liburing, only the opcodes of 5.6 kernels are used (OPENAT and READ)
+	class AsyncReader::Uring
+	{
+	public:
+		explicit Uring(AsyncReader& owner) : m_Owner(owner) {}
+
+		~Uring()
+		{
+			if (m_Thread.joinable())
+			{
+				{
+					std::lock_guard lock(m_Mutex);
+					m_IsShouldExit = true;
+				}
+				Wake();
+				m_Thread.join();
+			}
+
+			CloseRing();
+			if (m_EventFd >= 0)
+				close(m_EventFd);
+		}
+
+		// Fails on kernels without io_uring or the needed opcodes and where seccomp forbids it
+		bool Create()
+		{
+			io_uring_params params{};
+			m_RingFd = static_cast<int>(syscall(__NR_io_uring_setup, MaxInFlight * 2, &params));
+			if (m_RingFd < 0)
+				return false;
+
+			io_uring_probe* probe = static_cast<io_uring_probe*>(calloc(1, sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op)));
+			const auto isProbed = syscall(__NR_io_uring_register, m_RingFd, IORING_REGISTER_PROBE, probe, 256) == 0;
+			const auto isSupported = [&](uint8_t op) {
+				return op <= probe->last_op && (probe->ops[op].flags & IO_URING_OP_SUPPORTED);
+			};
+			const auto hasOps = isProbed && isSupported(IORING_OP_OPENAT) && isSupported(IORING_OP_READ);
+			free(probe);
+			if (!hasOps)
+				return false;
+
+			m_SqRingSize = params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+			m_CqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+			if (params.features & IORING_FEAT_SINGLE_MMAP)
+				m_SqRingSize = m_CqRingSize = std::max(m_SqRingSize, m_CqRingSize);
+
+			m_SqRing = Map(m_SqRingSize, IORING_OFF_SQ_RING);
+			m_CqRing = params.features & IORING_FEAT_SINGLE_MMAP ? m_SqRing : Map(m_CqRingSize, IORING_OFF_CQ_RING);
+			m_SqesSize = params.sq_entries * sizeof(io_uring_sqe);
+			m_Sqes = static_cast<io_uring_sqe*>(Map(m_SqesSize, IORING_OFF_SQES));
+			if (!m_SqRing || !m_CqRing || !m_Sqes)
+				return false;
+
+			auto* sq = static_cast<uint8_t*>(m_SqRing);
+			m_SqTail = reinterpret_cast<uint32_t*>(sq + params.sq_off.tail);
+			m_SqMask = *reinterpret_cast<uint32_t*>(sq + params.sq_off.ring_mask);
+			m_SqArray = reinterpret_cast<uint32_t*>(sq + params.sq_off.array);
+
+			auto* cq = static_cast<uint8_t*>(m_CqRing);
+			m_CqHead = reinterpret_cast<uint32_t*>(cq + params.cq_off.head);
+			m_CqTail = reinterpret_cast<uint32_t*>(cq + params.cq_off.tail);
+			m_CqMask = *reinterpret_cast<uint32_t*>(cq + params.cq_off.ring_mask);
+			m_Cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+
+			// A read of the eventfd stays queued all the time, so new requests wake the thread out of io_uring_enter
+			m_EventFd = eventfd(0, EFD_CLOEXEC);
+			if (m_EventFd < 0)
+				return false;
+
+			m_Thread = std::thread([this] { Run(); });
+			return true;
+		}
+
+		// Returns false and leaves the request alone once the ring failed, the caller reads it on the thread pool then
+		bool Read(Request& request)
+		{
+			{
+				std::lock_guard lock(m_Mutex);
+				if (m_IsFailed)
+					return false;
+				m_Incoming.emplace_back(std::move(request));
+			}
+			Wake();
+			return true;
+		}
+
+		[[nodiscard]] bool IsFailed() const noexcept
+		{
+			return m_IsFailed;
+		}
+
+	private:
+		static constexpr uint64_t WakeTag = 0;
+
+		struct Operation
+		{
+			Request request{};
+			uint64_t offset{};
+			int fd{-1};
+		};
+
+		void* Map(size_t size, uint64_t offset) const
+		{
+			auto* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, m_RingFd, static_cast<off_t>(offset));
+			return memory == MAP_FAILED ? nullptr : memory;
+		}
+
+		// The kernel holds the ring until its mappings are gone as well, then cancels what is still queued in it
+		void CloseRing()
+		{
+			if (m_Sqes)
+				munmap(m_Sqes, m_SqesSize);
+			if (m_CqRing && m_CqRing != m_SqRing)
+				munmap(m_CqRing, m_CqRingSize);
+			if (m_SqRing)
+				munmap(m_SqRing, m_SqRingSize);
+			if (m_RingFd >= 0)
+				close(m_RingFd);
+			m_Sqes = nullptr;
+			m_CqRing = m_SqRing = nullptr;
+			m_RingFd = -1;
+		}
+
+		// Nothing completes on a broken ring anymore. The reads in flight and the queued ones fail, so Wait returns,
+		// and the requests that come later go to the thread pool.
+		void Fail()
+		{
+			std::deque<Request> incoming{};
+			{
+				std::lock_guard lock(m_Mutex);
+				m_IsFailed = true;
+				incoming.swap(m_Incoming);
+			}
+
+			CloseRing();
+			for (auto* read : std::exchange(m_Operations, {}))
+				Complete(read, false);
+			for (auto& request : incoming)
+			{
+				request.callback(false);
+				m_Owner.Finish();
+			}
+		}
+
+		void Wake() const
+		{
+			const uint64_t value = 1;
+			[[maybe_unused]] const auto result = write(m_EventFd, &value, sizeof(value));
+		}
+
+		// The SQ is twice the in flight limit and every read has one operation queued at most, so it never fills up
+		io_uring_sqe* GetSqe()
+		{
+			const auto index = m_LocalTail & m_SqMask;
+			auto* sqe = &m_Sqes[index];
+			std::memset(sqe, 0, sizeof(*sqe));
+			m_SqArray[index] = index;
+			++m_LocalTail;
+			return sqe;
+		}
+
+		void PrepareWake()
+		{
+			auto* sqe = GetSqe();
+			sqe->opcode = IORING_OP_READ;
+			sqe->fd = m_EventFd;
+			sqe->addr = reinterpret_cast<uint64_t>(&m_WakeValue);
+			sqe->len = sizeof(m_WakeValue);
+			sqe->user_data = WakeTag;
+		}
+
+		void PrepareOpen(Operation* read)
+		{
+			auto* sqe = GetSqe();
+			sqe->opcode = IORING_OP_OPENAT;
+			sqe->fd = AT_FDCWD;
+			sqe->addr = reinterpret_cast<uint64_t>(read->request.path.c_str());
+			sqe->open_flags = O_RDONLY | O_CLOEXEC;
+			sqe->user_data = reinterpret_cast<uint64_t>(read);
+		}
+
+		void PrepareRead(Operation* read)
+		{
+			// A single read is capped below 2 GiB by the kernel, larger files take several
+			auto& dest = *read->request.dest;
+			auto* sqe = GetSqe();
+			sqe->opcode = IORING_OP_READ;
+			sqe->fd = read->fd;
+			sqe->addr = reinterpret_cast<uint64_t>(dest.data() + read->offset);
+			sqe->len = static_cast<uint32_t>(std::min<uint64_t>(dest.size() - read->offset, 1u << 30));
+			sqe->off = read->offset;
+			sqe->user_data = reinterpret_cast<uint64_t>(read);
+		}
+
+		void Complete(Operation* read, bool isSuccess)
+		{
+			if (read->fd >= 0)
+				close(read->fd);
+			read->request.callback(isSuccess);
+			m_Operations.erase(read);
+			delete read;
+			--m_InFlight;
+			m_Owner.Finish();
+		}
+
+		void OnCompletion(Operation* read, int result)
+		{
+			if (result < 0)
+			{
+				Complete(read, false);
+				return;
+			}
+
+			auto& dest = *read->request.dest;
+			if (read->fd < 0)
+			{
+				// Opened, the size comes from the inode that the open just loaded, so fstat never waits for the disk
+				read->fd = result;
+				struct stat status{};
+				if (fstat(read->fd, &status) != 0)
+				{
+					Complete(read, false);
+					return;
+				}
+
+				// Every byte is overwritten by the reads. The size is captured, some standard libraries pass the grown
+				// capacity to the operation instead of the requested size.
+				const auto size = static_cast<size_t>(status.st_size);
+				dest.resize_and_overwrite(size, [size](char*, size_t) { return size; });
+			}
+			else
+			{
+				// End of file before the expected size, the file was truncated while it was read
+				if (result == 0)
+				{
+					Complete(read, false);
+					return;
+				}
+				read->offset += static_cast<uint64_t>(result);
+			}
+
+			if (read->offset == dest.size())
+				Complete(read, true);
+			else
+				PrepareRead(read);
+		}
+
+		void Run()
+		{
+			m_LocalTail = *m_SqTail;
+			PrepareWake();
+
+			std::vector<Request> incoming{};
+			while (true)
+			{
+				{
+					std::lock_guard lock(m_Mutex);
+					if (m_IsShouldExit && m_Incoming.empty() && m_InFlight == 0)
+						break;
+
+					// Everything that arrived since the last wakeup goes into the same submission
+					const auto count = std::min<size_t>(m_Incoming.size(), MaxInFlight - m_InFlight);
+					std::move(m_Incoming.begin(), m_Incoming.begin() + static_cast<ptrdiff_t>(count), std::back_inserter(incoming));
+					m_Incoming.erase(m_Incoming.begin(), m_Incoming.begin() + static_cast<ptrdiff_t>(count));
+				}
+
+				for (auto& request : incoming)
+				{
+					++m_InFlight;
+					auto* read = new Operation{std::move(request)};
+					m_Operations.insert(read);
+					PrepareOpen(read);
+				}
+				incoming.clear();
+
+				const auto toSubmit = m_LocalTail - *m_SqTail;
+				std::atomic_ref(*m_SqTail).store(m_LocalTail, std::memory_order_release);
+				const auto result = syscall(__NR_io_uring_enter, m_RingFd, toSubmit, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+				if (result < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY)
+				{
+					OE_CORE_ERROR("io_uring_enter failed, files are read on the thread pool from now on: {}", std::strerror(errno));
+					Fail();
+					break;
+				}
+
+				auto head = *m_CqHead;
+				const auto tail = std::atomic_ref(*m_CqTail).load(std::memory_order_acquire);
+				for (; head != tail; ++head)
+				{
+					const auto& cqe = m_Cqes[head & m_CqMask];
+					if (cqe.user_data == WakeTag)
+						PrepareWake();
+					else
+						OnCompletion(reinterpret_cast<Operation*>(cqe.user_data), cqe.res);
+				}
+				std::atomic_ref(*m_CqHead).store(head, std::memory_order_release);
+			}
+		}
+
+		AsyncReader& m_Owner;
+		std::thread m_Thread{};
+
+		std::mutex m_Mutex{};
+		std::deque<Request> m_Incoming{};
+		bool m_IsShouldExit{};
+		std::atomic<bool> m_IsFailed{};
+
+		// Owned by the ring thread
+		std::unordered_set<Operation*> m_Operations{};
+		uint32_t m_InFlight{};
+		uint32_t m_LocalTail{};
+		uint64_t m_WakeValue{};
+
+		int m_RingFd{-1};
+		int m_EventFd{-1};
+		void* m_SqRing{};
+		void* m_CqRing{};
+		size_t m_SqRingSize{};
+		size_t m_CqRingSize{};
+		io_uring_sqe* m_Sqes{};
+		size_t m_SqesSize{};
+		uint32_t* m_SqTail{};
+		uint32_t* m_SqArray{};
+		uint32_t m_SqMask{};
+		uint32_t* m_CqHead{};
+		uint32_t* m_CqTail{};
+		io_uring_cqe* m_Cqes{};
+		uint32_t m_CqMask{};
+	};
+#else
+	class AsyncReader::Uring
+	{
+	public:
+		[[nodiscard]] bool IsFailed() const noexcept
+		{
+			return true;
+		}
+	};
+#endif
+
+	AsyncReader::AsyncReader(uint32_t threadsCount)
+	{
+#ifdef OE_IO_URING
+		m_Uring = std::make_unique<Uring>(*this);
+		if (!m_Uring->Create())
+		{
+			OE_CORE_INFO("io_uring is not available, files are read on a thread pool");
+			m_Uring.reset();
+		}
+#endif
+
+		for (uint32_t i{}; i < std::max(1u, threadsCount); ++i)
+			m_Threads.emplace_back([this] { RunThread(); });
+	}
+
+	AsyncReader::~AsyncReader()
+	{
+		Wait();
+		m_Uring.reset();
+		{
+			std::lock_guard lock(m_Mutex);
+			m_IsShouldExit = true;
+		}
+		m_Condition.notify_all();
+		for (auto& thread : m_Threads)
+			thread.join();
+	}
+
+	void AsyncReader::Read(std::string path, std::string& dest, ReadCallback callback)
+	{
+		{
+			std::lock_guard lock(m_Mutex);
+			++m_Pending;
+		}
+
+		Request request{std::move(path), &dest, std::move(callback)};
+#ifdef OE_IO_URING
+		if (m_Uring && m_Uring->Read(request))
+			return;
+#endif
+
+		std::lock_guard lock(m_Mutex);
+		m_Tasks.emplace_back([request = std::move(request)] { request.callback(ReadFileBlocking(request.path, *request.dest)); });
+		m_Condition.notify_one();
+	}
+
+	void AsyncReader::Run(std::function<void()> task)
+	{
+		std::lock_guard lock(m_Mutex);
+		++m_Pending;
+		m_Tasks.emplace_back(std::move(task));
+		m_Condition.notify_one();
+	}
+
+	void AsyncReader::Wait()
+	{
+		std::unique_lock lock(m_Mutex);
+		m_IdleCondition.wait(lock, [this] { return m_Pending == 0; });
+	}
+
+	bool AsyncReader::IsUring() const noexcept
+	{
+		return m_Uring && !m_Uring->IsFailed();
+	}
+
+	void AsyncReader::RunThread()
+	{
+		while (true)
+		{
+			std::function<void()> task{};
+			{
+				std::unique_lock lock(m_Mutex);
+				m_Condition.wait(lock, [this] { return m_IsShouldExit || !m_Tasks.empty(); });
+				if (m_Tasks.empty())
+					return;
+				task = std::move(m_Tasks.front());
+				m_Tasks.pop_front();
+			}
+
+			task();
+			Finish();
+		}
+	}
+
+	void AsyncReader::Finish()
+	{
+		std::lock_guard lock(m_Mutex);
+		if (--m_Pending == 0)
+			m_IdleCondition.notify_all();
+	}
+} // namespace oe::FileSystem
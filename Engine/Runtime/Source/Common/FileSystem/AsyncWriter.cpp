@@ -0,0 +1,259 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#include "Oneiro/Common/FileSystem/AsyncWriter.hpp"
+
+#include "Oneiro/Common/Common.hpp"
+#include "Oneiro/Common/FileSystem/FileSystem.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <set>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace oe::FileSystem
+{
+	namespace
+	{
+#ifdef _WIN32
+		using NativeFile = HANDLE;
+		const NativeFile InvalidNativeFile = INVALID_HANDLE_VALUE;
+#else
+		using NativeFile = int;
+		constexpr NativeFile InvalidNativeFile = -1;
+#endif
+
+		std::filesystem::path GetTemporaryPath(const std::filesystem::path& path)
+		{
+			auto temporaryPath = path;
+			temporaryPath += ".tmp";
+			return temporaryPath;
+		}
+
+		NativeFile CreateTemporaryFile(const std::filesystem::path& path, const std::string& data)
+		{
+#ifdef _WIN32
+			const auto file = CreateFileW(path.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (file == INVALID_HANDLE_VALUE)
+				return InvalidNativeFile;
+
+			for (size_t offset{}; offset < data.size();)
+			{
+				DWORD written{};
+				const auto size = static_cast<DWORD>(std::min<size_t>(data.size() - offset, 1u << 30));
+				if (!WriteFile(file, data.data() + offset, size, &written, nullptr) || written == 0)
+				{
+					CloseHandle(file);
+					return InvalidNativeFile;
+				}
+				offset += written;
+			}
+			return file;
+#else
+			const auto file = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+			if (file < 0)
+				return InvalidNativeFile;
+
+			for (size_t offset{}; offset < data.size();)
+			{
+				const auto written = write(file, data.data() + offset, data.size() - offset);
+				if (written <= 0)
+				{
+					close(file);
+					return InvalidNativeFile;
+				}
+				offset += static_cast<size_t>(written);
+			}
+			return file;
+#endif
+		}
+
+		// Syncs and closes the file
+		bool SyncFile(NativeFile file)
+		{
+#ifdef _WIN32
+			const auto isSynced = FlushFileBuffers(file) != 0;
+			CloseHandle(file);
+#else
+			const auto isSynced = fsync(file) == 0;
+			close(file);
+#endif
+			return isSynced;
+		}
+
+		bool ReplaceFile(const std::filesystem::path& temporaryPath, const std::filesystem::path& path)
+		{
+#ifdef _WIN32
+			return MoveFileExW(temporaryPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0;
+#else
+			return std::rename(temporaryPath.c_str(), path.c_str()) == 0;
+#endif
+		}
+
+		// Makes the renames durable, Windows does that with MOVEFILE_WRITE_THROUGH
+		void SyncDirectory([[maybe_unused]] const std::filesystem::path& directory)
+		{
+#ifndef _WIN32
+			const auto file = open(directory.empty() ? "." : directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+			if (file < 0)
+				return;
+			fsync(file);
+			close(file);
+#endif
+		}
+	} // namespace
+
+	AsyncWriter::AsyncWriter()
+	{
+		m_Thread = std::thread([this] { RunThread(); });
+	}
+
+	AsyncWriter::~AsyncWriter()
+	{
+		{
+			std::lock_guard lock(m_Mutex);
+			m_IsShouldExit = true;
+		}
+		m_Condition.notify_all();
+		m_Thread.join();
+	}
+
+	std::shared_future<bool> AsyncWriter::Write(const std::filesystem::path& path, std::string data)
+	{
+		auto key = path.lexically_normal().string();
+
+		std::unique_lock lock(m_Mutex);
+		if (const auto& queued = m_Queued.find(key); queued != m_Queued.end())
+		{
+			queued->second.data = std::move(data);
+			return queued->second.future;
+		}
+
+		Request request{path, std::move(data)};
+		request.future = request.promise.get_future().share();
+		auto future = request.future;
+		m_Order.push_back(key);
+		m_Queued.emplace(std::move(key), std::move(request));
+		m_PendingCount.fetch_add(1, std::memory_order_release);
+		lock.unlock();
+
+		m_Condition.notify_one();
+		return future;
+	}
+
+	void AsyncWriter::Wait()
+	{
+		std::unique_lock lock(m_Mutex);
+		m_IdleCondition.wait(lock, [this] { return m_Queued.empty() && m_InFlight.empty(); });
+	}
+
+	void AsyncWriter::Wait(const std::filesystem::path& path)
+	{
+		if (IsIdle())
+			return;
+
+		const auto key = path.lexically_normal().string();
+		std::shared_future<bool> future{};
+		{
+			std::lock_guard lock(m_Mutex);
+			if (const auto& queued = m_Queued.find(key); queued != m_Queued.end())
+				future = queued->second.future;
+			else if (const auto& inFlight = m_InFlight.find(key); inFlight != m_InFlight.end())
+				future = inFlight->second;
+		}
+
+		if (future.valid())
+			future.wait();
+	}
+
+	bool AsyncWriter::WriteBlocking(const std::filesystem::path& path, const std::string& data)
+	{
+		std::vector<Request> batch(1);
+		batch[0].path = path;
+		batch[0].data = data;
+		auto future = batch[0].promise.get_future();
+		Commit(batch);
+		return future.get();
+	}
+
+	void AsyncWriter::RunThread()
+	{
+		while (true)
+		{
+			std::vector<Request> batch{};
+			{
+				std::unique_lock lock(m_Mutex);
+				m_Condition.wait(lock, [this] { return m_IsShouldExit || !m_Queued.empty(); });
+				if (m_Queued.empty())
+					return;
+
+				while (!m_Order.empty() && batch.size() < MaxBatchSize)
+				{
+					auto queued = m_Queued.extract(m_Order.front());
+					m_Order.pop_front();
+					m_InFlight.emplace(std::move(queued.key()), queued.mapped().future);
+					batch.emplace_back(std::move(queued.mapped()));
+				}
+			}
+
+			Commit(batch);
+
+			std::lock_guard lock(m_Mutex);
+			for (const auto& request : batch)
+				m_InFlight.erase(request.path.lexically_normal().string());
+			m_PendingCount.fetch_sub(batch.size(), std::memory_order_release);
+			if (m_Queued.empty() && m_InFlight.empty())
+				m_IdleCondition.notify_all();
+		}
+	}
+
+	void AsyncWriter::Commit(std::vector<Request>& batch)
+	{
+		// Every file is written before the first sync, so the syncs of a batch find most of the data on its way already
+		std::vector<NativeFile> files(batch.size(), InvalidNativeFile);
+		for (size_t i{}; i < batch.size(); ++i)
+		{
+			std::error_code error{};
+			std::filesystem::create_directories(batch[i].path.parent_path(), error);
+			files[i] = CreateTemporaryFile(GetTemporaryPath(batch[i].path), batch[i].data);
+		}
+
+		std::vector<bool> isWritten(batch.size());
+		std::set<std::filesystem::path> directories{};
+		for (size_t i{}; i < batch.size(); ++i)
+		{
+			const auto& path = batch[i].path;
+			const auto temporaryPath = GetTemporaryPath(path);
+			isWritten[i] = files[i] != InvalidNativeFile && SyncFile(files[i]) && ReplaceFile(temporaryPath, path);
+			if (isWritten[i])
+			{
+				directories.emplace(path.parent_path());
+				continue;
+			}
+
+			OE_CORE_ERROR("Failed to write '{}'!", path.string());
+			std::error_code error{};
+			std::filesystem::remove(temporaryPath, error);
+		}
+
+		for (const auto& directory : directories)
+			SyncDirectory(directory);
+
+		// Completed only once the renames are durable
+		for (size_t i{}; i < batch.size(); ++i)
+		{
+			if (isWritten[i])
+				RefreshIndex(batch[i].path);
+			batch[i].data = {};
+			batch[i].promise.set_value(isWritten[i]);
+		}
+	}
+} // namespace oe::FileSystem
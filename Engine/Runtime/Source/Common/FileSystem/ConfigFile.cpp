@@ -27,30 +27,38 @@ namespace oe::FileSystem
 	{
 		m_Path = path;
 		auto data = Read(m_Path);
-		return LoadFromData(data);
+		if (!LoadFromData(data))
+			return false;
+
+		m_SavedData = Serialize();
+		return true;
 	}
 
 	bool ConfigFile::Save()
 	{
-		rapidjson::StringBuffer writerBuffer;
-		rapidjson::Writer<rapidjson::StringBuffer> writer(writerBuffer);
-		m_File.Accept(writer);
+		// Configs are saved on every destruction, the file is only written when something changed
+		auto buffer = Serialize();
+		if (buffer.empty() || m_Path.empty() || buffer == m_SavedData)
+			return true;
 
-		const std::string buffer{writerBuffer.GetString()};
-		if (!buffer.empty() && !m_Path.empty())
-			Write(m_Path, reinterpret_cast<const uint8_t*>(buffer.c_str()), buffer.size());
+		WriteAsync(m_Path, buffer);
+		m_SavedData = std::move(buffer);
 		return true;
 	}
 
 	bool ConfigFile::Save(const Path& path)
+	{
+		auto buffer = Serialize();
+		if (!buffer.empty() && !path.empty())
+			WriteAsync(path, std::move(buffer));
+		return true;
+	}
+
+	std::string ConfigFile::Serialize() const
 	{
 		rapidjson::StringBuffer writerBuffer;
 		rapidjson::Writer<rapidjson::StringBuffer> writer(writerBuffer);
 		m_File.Accept(writer);
-
-		const std::string buffer{writerBuffer.GetString()};
-		if (!buffer.empty() && !path.empty())
-			Write(path, reinterpret_cast<const uint8_t*>(buffer.c_str()), buffer.size());
-		return true;
+		return {writerBuffer.GetString(), writerBuffer.GetSize()};
 	}
 } // namespace oe::FileSystem
\ No newline at end of file
@@ -0,0 +1,531 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#include "Oneiro/Common/FileSystem/DirectoryIndex.hpp"
+
+#include "Oneiro/Common/Common.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace oe::FileSystem
+{
+	namespace
+	{
+		std::string_view GetParentPath(std::string_view path) noexcept
+		{
+			const auto separator = path.rfind('/');
+			return separator == std::string_view::npos ? std::string_view{} : path.substr(0, separator);
+		}
+
+		std::string_view GetFileName(std::string_view path) noexcept
+		{
+			const auto separator = path.rfind('/');
+			return separator == std::string_view::npos ? path : path.substr(separator + 1);
+		}
+
+		std::string JoinPath(std::string_view directory, std::string_view name)
+		{
+			if (directory.empty())
+				return std::string{name};
+
+			std::string path{directory};
+			path += '/';
+			path += name;
+			return path;
+		}
+
+		std::optional<FileStat> GetNativeStat(const std::filesystem::directory_entry& entry)
+		{
+			std::error_code error{};
+			FileStat stat{};
+			stat.isDirectory = entry.is_directory(error);
+			if (!stat.isDirectory && !entry.is_regular_file(error))
+				return std::nullopt;
+
+			if (!stat.isDirectory)
+				stat.size = entry.file_size(error);
+
+			const auto time = entry.last_write_time(error);
+			if (!error)
+			{
+				// clock_cast to the system clock is not available everywhere yet
+				const auto systemTime =
+					std::chrono::system_clock::now() + std::chrono::duration_cast<std::chrono::system_clock::duration>(
+														   time - std::filesystem::file_time_type::clock::now());
+				stat.modifiedTime = std::chrono::duration_cast<std::chrono::seconds>(systemTime.time_since_epoch()).count();
+			}
+			return stat;
+		}
+	} // namespace
+
+#ifdef __linux__
+	// One inotify watch per directory of the mounted directories, events are turned into Refresh calls on the
+	// watcher thread
+	class DirectoryIndex::Watcher
+	{
+	public:
+		explicit Watcher(DirectoryIndex& index) : m_Index(index)
+		{
+			m_Fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+			m_EventFd = eventfd(0, EFD_CLOEXEC);
+			if (IsValid())
+				m_Thread = std::thread([this] { Run(); });
+		}
+
+		Watcher(const Watcher&) = delete;
+		Watcher& operator=(const Watcher&) = delete;
+
+		~Watcher()
+		{
+			if (m_Thread.joinable())
+			{
+				const uint64_t value = 1;
+				[[maybe_unused]] const auto written = write(m_EventFd, &value, sizeof(value));
+				m_Thread.join();
+			}
+
+			if (m_Fd >= 0)
+				close(m_Fd);
+			if (m_EventFd >= 0)
+				close(m_EventFd);
+		}
+
+		[[nodiscard]] bool IsValid() const noexcept
+		{
+			return m_Fd >= 0 && m_EventFd >= 0;
+		}
+
+		// Watches the directory and every directory below it
+		void AddDirectory(const std::filesystem::path& directory)
+		{
+			AddWatch(directory);
+
+			std::error_code error{};
+			for (std::filesystem::recursive_directory_iterator iterator(directory, error), end; !error && iterator != end;
+				 iterator.increment(error))
+			{
+				if (iterator->is_directory(error))
+					AddWatch(iterator->path());
+			}
+		}
+
+	private:
+		static constexpr uint32_t WatchMask =
+			IN_CREATE | IN_DELETE | IN_CLOSE_WRITE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_ONLYDIR | IN_EXCL_UNLINK;
+
+		void AddWatch(const std::filesystem::path& directory)
+		{
+			const auto descriptor = inotify_add_watch(m_Fd, directory.c_str(), WatchMask);
+			if (descriptor < 0)
+			{
+				OE_CORE_WARN("Failed to watch '{}' for changes!", directory.string());
+				return;
+			}
+
+			std::lock_guard lock(m_Mutex);
+			m_Directories[descriptor] = directory;
+		}
+
+		void Run()
+		{
+			alignas(inotify_event) char buffer[64 * 1024];
+			pollfd descriptors[] = {{m_Fd, POLLIN, 0}, {m_EventFd, POLLIN, 0}};
+			while (true)
+			{
+				if (poll(descriptors, 2, -1) < 0)
+					continue;
+				if (descriptors[1].revents & POLLIN)
+					return;
+
+				const auto size = read(m_Fd, buffer, sizeof(buffer));
+				if (size <= 0)
+					continue;
+
+				for (auto offset = 0l; offset < size;)
+				{
+					const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+					offset += static_cast<long>(sizeof(inotify_event) + event->len);
+					HandleEvent(*event);
+				}
+			}
+		}
+
+		void HandleEvent(const inotify_event& event)
+		{
+			// Events were dropped, only a rescan of everything gets the index right again
+			if (event.mask & IN_Q_OVERFLOW)
+			{
+				std::vector<std::filesystem::path> directories{};
+				{
+					std::shared_lock lock(m_Index.m_Mutex);
+					for (const auto& mount : m_Index.m_Mounts)
+						directories.emplace_back(mount.directory);
+				}
+				for (const auto& directory : directories)
+					m_Index.Refresh(directory);
+				return;
+			}
+
+			std::filesystem::path directory{};
+			{
+				std::lock_guard lock(m_Mutex);
+				const auto& found = m_Directories.find(event.wd);
+				if (found == m_Directories.end())
+					return;
+				if (event.mask & IN_IGNORED)
+				{
+					m_Directories.erase(found);
+					return;
+				}
+				directory = found->second;
+			}
+
+			if (event.mask & IN_DELETE_SELF)
+				return;
+
+			const auto path = event.len != 0 ? directory / event.name : directory;
+			if ((event.mask & (IN_CREATE | IN_MOVED_TO)) && (event.mask & IN_ISDIR))
+				AddDirectory(path);
+			m_Index.Refresh(path);
+		}
+
+		DirectoryIndex& m_Index;
+		std::mutex m_Mutex{};
+		std::unordered_map<int, std::filesystem::path> m_Directories{};
+		std::thread m_Thread{};
+		int m_Fd{-1};
+		int m_EventFd{-1};
+	};
+#else
+	class DirectoryIndex::Watcher
+	{
+	};
+#endif
+
+	DirectoryIndex::DirectoryIndex() = default;
+
+	DirectoryIndex::~DirectoryIndex()
+	{
+		StopWatching();
+	}
+
+	void DirectoryIndex::Clear()
+	{
+		std::lock_guard lock(m_Mutex);
+		m_Nodes.clear();
+	}
+
+	void DirectoryIndex::Add(std::string_view path, const FileStat& stat)
+	{
+		const auto normalized = NormalizePath(path);
+		std::lock_guard lock(m_Mutex);
+		AddLocked(normalized, stat);
+	}
+
+	void DirectoryIndex::Remove(std::string_view path)
+	{
+		const auto normalized = NormalizePath(path);
+		std::lock_guard lock(m_Mutex);
+		RemoveLocked(normalized);
+	}
+
+	std::optional<FileStat> DirectoryIndex::Stat(std::string_view path) const
+	{
+		const auto normalized = NormalizePath(path);
+		std::shared_lock lock(m_Mutex);
+		const auto& node = m_Nodes.find(normalized);
+		if (node == m_Nodes.end())
+			return std::nullopt;
+		return node->second.stat;
+	}
+
+	bool DirectoryIndex::IsExists(std::string_view path) const
+	{
+		return Stat(path).has_value();
+	}
+
+	std::vector<DirectoryEntry> DirectoryIndex::List(std::string_view path) const
+	{
+		const auto normalized = NormalizePath(path);
+		std::shared_lock lock(m_Mutex);
+		const auto& node = m_Nodes.find(normalized);
+		if (node == m_Nodes.end())
+			return {};
+
+		std::vector<DirectoryEntry> entries{};
+		entries.reserve(node->second.children.size());
+		for (const auto& name : node->second.children)
+		{
+			const auto& child = m_Nodes.find(JoinPath(normalized, name));
+			if (child != m_Nodes.end())
+				entries.push_back({name, child->second.stat});
+		}
+		return entries;
+	}
+
+	void DirectoryIndex::AddMount(const std::filesystem::path& directory, std::string_view mountPoint)
+	{
+		std::error_code error{};
+		auto absoluteDirectory = std::filesystem::weakly_canonical(std::filesystem::absolute(directory, error), error);
+		{
+			std::lock_guard lock(m_Mutex);
+			m_Mounts.push_back({absoluteDirectory, NormalizePath(mountPoint)});
+		}
+
+#ifdef __linux__
+		if (m_Watcher)
+			m_Watcher->AddDirectory(absoluteDirectory);
+#endif
+	}
+
+	void DirectoryIndex::RemoveMount(const std::filesystem::path& directory)
+	{
+		std::error_code error{};
+		const auto absoluteDirectory = std::filesystem::weakly_canonical(std::filesystem::absolute(directory, error), error);
+
+		std::lock_guard lock(m_Mutex);
+		std::erase_if(m_Mounts, [&absoluteDirectory](const auto& mount) { return mount.directory == absoluteDirectory; });
+	}
+
+	void DirectoryIndex::Refresh(const std::filesystem::path& nativePath)
+	{
+		std::error_code error{};
+		// Canonical like the mounted directories, removed files still resolve through their existing parents
+		const auto absolutePath = std::filesystem::weakly_canonical(std::filesystem::absolute(nativePath, error), error);
+
+		std::optional<std::string> path{};
+		{
+			std::shared_lock lock(m_Mutex);
+			path = GetVirtualPath(absolutePath);
+		}
+		if (!path)
+			return;
+
+		// The disk is scanned without the lock, so queries only wait for the index update itself
+		std::vector<std::pair<std::string, FileStat>> entries{};
+		const std::filesystem::directory_entry entry(absolutePath, error);
+		if (const auto stat = GetNativeStat(entry))
+		{
+			entries.emplace_back(*path, *stat);
+			if (stat->isDirectory)
+			{
+				for (std::filesystem::recursive_directory_iterator iterator(absolutePath, error), end; !error && iterator != end;
+					 iterator.increment(error))
+				{
+					if (const auto childStat = GetNativeStat(*iterator))
+						entries.emplace_back(JoinPath(*path, iterator->path().lexically_relative(absolutePath).generic_string()), *childStat);
+				}
+			}
+		}
+
+		// Entries that are gone from this directory may still come from another mounted directory. Children come before
+		// their parents, so a directory is only dropped when nothing below it is left.
+		std::vector<std::string> removed{};
+		{
+			std::shared_lock lock(m_Mutex);
+			removed = GetPathsLocked(*path);
+		}
+		std::unordered_set<std::string_view> scanned{};
+		for (const auto& item : entries)
+			scanned.emplace(item.first);
+		std::erase_if(removed, [&](const std::string& removedPath) {
+			return scanned.contains(removedPath) || IsInOtherMount(removedPath, absolutePath);
+		});
+		std::ranges::sort(removed, std::greater<>{});
+
+		std::lock_guard lock(m_Mutex);
+		for (const auto& removedPath : removed)
+		{
+			const auto& node = m_Nodes.find(removedPath);
+			if (node != m_Nodes.end() && node->second.children.empty())
+				RemoveLocked(removedPath);
+		}
+		for (const auto& [entryPath, stat] : entries)
+			AddLocked(entryPath, stat);
+	}
+
+	bool DirectoryIndex::Watch()
+	{
+#ifdef __linux__
+		if (m_Watcher)
+			return true;
+
+		auto watcher = std::make_unique<Watcher>(*this);
+		if (!watcher->IsValid())
+		{
+			OE_CORE_WARN("Failed to create a file system watcher!");
+			return false;
+		}
+
+		std::vector<std::filesystem::path> directories{};
+		{
+			std::shared_lock lock(m_Mutex);
+			for (const auto& mount : m_Mounts)
+				directories.emplace_back(mount.directory);
+		}
+		for (const auto& directory : directories)
+			watcher->AddDirectory(directory);
+
+		m_Watcher = std::move(watcher);
+		return true;
+#else
+		OE_CORE_WARN("Watching the file system for changes is not supported on this platform!");
+		return false;
+#endif
+	}
+
+	void DirectoryIndex::StopWatching()
+	{
+		m_Watcher.reset();
+	}
+
+	std::string DirectoryIndex::NormalizePath(std::string_view path)
+	{
+		std::string normalized{path};
+		std::replace(normalized.begin(), normalized.end(), '\\', '/');
+
+		size_t start{};
+		while (start < normalized.size())
+		{
+			if (normalized[start] == '/')
+				++start;
+			else if (normalized.compare(start, 2, "./") == 0)
+				start += 2;
+			else
+				break;
+		}
+		normalized.erase(0, start);
+		if (normalized == ".")
+			normalized.clear();
+
+		while (normalized.ends_with('/'))
+			normalized.pop_back();
+		return normalized;
+	}
+
+	void DirectoryIndex::AddLocked(const std::string& path, const FileStat& stat)
+	{
+		auto& node = m_Nodes[path];
+		// Loose files never replace archived ones, archives are searched first
+		if (node.stat.isArchived && !stat.isArchived)
+			return;
+		node.stat = stat;
+
+		// Parents are created up to the first one that already has the child
+		std::string_view child = path;
+		while (!child.empty())
+		{
+			const auto parentPath = GetParentPath(child);
+			auto& parent = m_Nodes[std::string{parentPath}];
+			parent.stat.isDirectory = true;
+			if (!parent.children.emplace(GetFileName(child)).second)
+				break;
+			child = parentPath;
+		}
+	}
+
+	bool DirectoryIndex::RemoveLocked(const std::string& path)
+	{
+		if (!RemoveNodeLocked(path) || path.empty())
+			return false;
+
+		const auto& parent = m_Nodes.find(GetParentPath(path));
+		if (parent != m_Nodes.end())
+		{
+			if (const auto& name = parent->second.children.find(GetFileName(path)); name != parent->second.children.end())
+				parent->second.children.erase(name);
+		}
+		return true;
+	}
+
+	bool DirectoryIndex::RemoveNodeLocked(const std::string& path)
+	{
+		const auto& node = m_Nodes.find(path);
+		if (node == m_Nodes.end())
+			return true;
+
+		auto& children = node->second.children;
+		for (auto child = children.begin(); child != children.end();)
+		{
+			if (RemoveNodeLocked(JoinPath(path, *child)))
+				child = children.erase(child);
+			else
+				++child;
+		}
+
+		// The root stays, everything is mounted below it
+		if (path.empty() || node->second.stat.isArchived || !children.empty())
+			return false;
+
+		m_Nodes.erase(node);
+		return true;
+	}
+
+	std::vector<std::string> DirectoryIndex::GetPathsLocked(const std::string& path) const
+	{
+		std::vector<std::string> paths{};
+		if (!m_Nodes.contains(path))
+			return paths;
+
+		paths.emplace_back(path);
+		for (size_t i{}; i < paths.size(); ++i)
+		{
+			const auto& node = m_Nodes.find(paths[i]);
+			if (node == m_Nodes.end())
+				continue;
+			for (const auto& child : node->second.children)
+				paths.emplace_back(JoinPath(paths[i], child));
+		}
+		return paths;
+	}
+
+	bool DirectoryIndex::IsInOtherMount(const std::string& path, const std::filesystem::path& nativeDirectory) const
+	{
+		std::vector<std::filesystem::path> nativePaths{};
+		{
+			std::shared_lock lock(m_Mutex);
+			for (const auto& mount : m_Mounts)
+			{
+				if (!mount.mountPoint.empty() && path != mount.mountPoint && !path.starts_with(mount.mountPoint + '/'))
+					continue;
+
+				const auto relative = path.substr(std::min(path.size(), mount.mountPoint.empty() ? 0 : mount.mountPoint.size() + 1));
+				auto nativePath = relative.empty() ? mount.directory : mount.directory / relative;
+				// The refreshed directory itself was scanned already
+				if (const auto inside = nativePath.lexically_relative(nativeDirectory); inside.empty() || *inside.begin() != "..")
+					continue;
+				nativePaths.emplace_back(std::move(nativePath));
+			}
+		}
+
+		std::error_code error{};
+		return std::ranges::any_of(nativePaths, [&error](const auto& nativePath) { return std::filesystem::exists(nativePath, error); });
+	}
+
+	std::optional<std::string> DirectoryIndex::GetVirtualPath(const std::filesystem::path& nativePath) const
+	{
+		for (const auto& mount : m_Mounts)
+		{
+			const auto relative = nativePath.lexically_relative(mount.directory);
+			if (relative.empty() || *relative.begin() == "..")
+				continue;
+
+			const auto relativeString = relative.generic_string();
+			return NormalizePath(JoinPath(mount.mountPoint, relativeString == "." ? std::string_view{} : std::string_view{relativeString}));
+		}
+		return std::nullopt;
+	}
+} // namespace oe::FileSystem
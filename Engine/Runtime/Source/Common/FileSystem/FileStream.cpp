@@ -0,0 +1,343 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#include "Oneiro/Common/FileSystem/FileStream.hpp"
+
+#include "Oneiro/Common/FileSystem/Archive.hpp"
+#include "Oneiro/Common/FileSystem/FileSystem.hpp"
+
+#include "physfs.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace oe::FileSystem
+{
+	namespace
+	{
+		constexpr size_t MinStreamBufferSize = 4096;
+
+		std::string GetPhysFSPath(const Path& path)
+		{
+			std::string pathString = path.string();
+			std::replace(pathString.begin(), pathString.end(), '\\', '/');
+			return pathString;
+		}
+	} // namespace
+
+	// Random access to the file behind a reader, archived entries are read from the archive mapping and everything
+	// else goes through PhysFS
+	class FileReader::Source
+	{
+	public:
+		explicit Source(PHYSFS_File* file) noexcept : m_File(file)
+		{
+		}
+
+		Source(Ref<Archive> archive, const ArchiveEntry* entry) noexcept : m_Archive(std::move(archive)), m_Entry(entry)
+		{
+		}
+
+		Source(const Source&) = delete;
+		Source& operator=(const Source&) = delete;
+
+		~Source()
+		{
+			if (m_File)
+				PHYSFS_close(m_File);
+		}
+
+		[[nodiscard]] uint64_t GetSize() const noexcept
+		{
+			if (m_Entry)
+				return m_Entry->uncompressedSize;
+			const auto length = PHYSFS_fileLength(m_File);
+			return length > 0 ? static_cast<uint64_t>(length) : 0;
+		}
+
+		size_t ReadAt(uint64_t offset, std::span<std::byte> destination)
+		{
+			if (m_File)
+			{
+				if (static_cast<uint64_t>(PHYSFS_tell(m_File)) != offset && !PHYSFS_seek(m_File, offset))
+					return 0;
+				const auto read = PHYSFS_readBytes(m_File, destination.data(), destination.size());
+				return read > 0 ? static_cast<size_t>(read) : 0;
+			}
+
+			const auto size = GetSize();
+			if (offset >= size)
+				return 0;
+
+			if (m_Entry->codec == EArchiveCodec::NONE)
+			{
+				const auto data = m_Archive->Read(*m_Entry).subspan(static_cast<size_t>(offset));
+				const auto count = std::min(destination.size(), data.size());
+				std::memcpy(destination.data(), data.data(), count);
+				return count;
+			}
+
+			// Compressed entries are decoded one block at a time, the last block is kept for the following reads
+			size_t read{};
+			while (read < destination.size() && offset < size)
+			{
+				const auto block = offset / m_Entry->blockSize;
+				if (block != m_Block)
+				{
+					m_BlockData.resize(m_Entry->blockSize);
+					if (!m_Archive->ExtractBlock(*m_Entry, block, m_BlockData))
+					{
+						m_Block = std::numeric_limits<uint64_t>::max();
+						break;
+					}
+					m_Block = block;
+				}
+
+				const auto blockBegin = block * m_Entry->blockSize;
+				const auto blockEnd = std::min<uint64_t>(blockBegin + m_Entry->blockSize, size);
+				const auto count = static_cast<size_t>(std::min<uint64_t>(destination.size() - read, blockEnd - offset));
+				std::memcpy(destination.data() + read, m_BlockData.data() + (offset - blockBegin), count);
+				read += count;
+				offset += count;
+			}
+			return read;
+		}
+
+	private:
+		PHYSFS_File* m_File{};
+		Ref<Archive> m_Archive{};
+		const ArchiveEntry* m_Entry{};
+		std::vector<std::byte> m_BlockData{};
+		uint64_t m_Block{std::numeric_limits<uint64_t>::max()};
+	};
+
+	FileReader::FileReader() = default;
+
+	FileReader::~FileReader()
+	{
+		Close();
+	}
+
+	bool FileReader::Open(const Path& path, size_t bufferSize)
+	{
+		Close();
+		WaitAsyncWrite(path);
+
+		Ref<Archive> archive{};
+		if (const auto* entry = FindArchived(path, archive))
+			m_Source = std::make_unique<Source>(std::move(archive), entry);
+		else if (auto* file = PHYSFS_openRead(GetPhysFSPath(path).c_str()))
+			m_Source = std::make_unique<Source>(file);
+		else
+			return false;
+
+		// Small files don't need the full buffers
+		m_Size = m_Source->GetSize();
+		bufferSize = static_cast<size_t>(std::min<uint64_t>(std::max(bufferSize, MinStreamBufferSize), std::max<uint64_t>(m_Size, 1)));
+		m_Current.data.resize(bufferSize);
+		m_Next.data.resize(bufferSize);
+
+		// The first chunk is read right away, the caller usually has other setup to do before the first Read
+		StartPrefetch(0);
+		return true;
+	}
+
+	void FileReader::Close()
+	{
+		WaitPrefetch();
+		m_Source.reset();
+		m_Current = {};
+		m_Next = {};
+		m_Position = 0;
+		m_Size = 0;
+	}
+
+	size_t FileReader::Read(std::span<std::byte> destination)
+	{
+		size_t read{};
+		while (read < destination.size() && m_Position < m_Size)
+		{
+			if (!m_Current.Contains(m_Position))
+			{
+				Fill(m_Position);
+				if (!m_Current.Contains(m_Position))
+					break;
+			}
+
+			const auto offset = static_cast<size_t>(m_Position - m_Current.offset);
+			const auto count = std::min(destination.size() - read, m_Current.size - offset);
+			std::memcpy(destination.data() + read, m_Current.data.data() + offset, count);
+			read += count;
+			m_Position += count;
+		}
+		return read;
+	}
+
+	bool FileReader::Seek(uint64_t position)
+	{
+		if (!m_Source || position > m_Size)
+			return false;
+		m_Position = position;
+		return true;
+	}
+
+	bool FileReader::Skip(uint64_t bytes)
+	{
+		return bytes <= m_Size - m_Position && Seek(m_Position + bytes);
+	}
+
+	void FileReader::Fill(uint64_t position)
+	{
+		WaitPrefetch();
+		if (m_Next.Contains(position))
+		{
+			std::swap(m_Current, m_Next);
+		}
+		else
+		{
+			// Seeked away from the read ahead
+			m_Current.offset = position;
+			m_Current.size = m_Source->ReadAt(position, m_Current.data);
+		}
+
+		if (m_Current.size != 0)
+			StartPrefetch(m_Current.offset + m_Current.size);
+	}
+
+	void FileReader::StartPrefetch(uint64_t offset)
+	{
+		if (offset >= m_Size)
+			return;
+
+		m_Next.offset = offset;
+		m_Next.size = 0;
+		{
+			std::lock_guard lock(m_Mutex);
+			m_IsPrefetching = true;
+		}
+
+		RunAsync([this] {
+			const auto size = m_Source->ReadAt(m_Next.offset, m_Next.data);
+
+			std::lock_guard lock(m_Mutex);
+			m_Next.size = size;
+			m_IsPrefetching = false;
+			m_Condition.notify_all();
+		});
+	}
+
+	void FileReader::WaitPrefetch()
+	{
+		std::unique_lock lock(m_Mutex);
+		m_Condition.wait(lock, [this] { return !m_IsPrefetching; });
+	}
+
+	FileWriter::~FileWriter()
+	{
+		Close();
+	}
+
+	bool FileWriter::Open(const Path& path, size_t bufferSize)
+	{
+		Close();
+		// A queued write would replace the file after this one
+		WaitAsyncWrite(path);
+
+		PHYSFS_setWriteDir(PHYSFS_getBaseDir());
+		m_Path = GetPhysFSPath(path);
+		m_File = PHYSFS_openWrite(m_Path.c_str());
+		if (!m_File)
+		{
+			OE_CORE_ERROR("Failed to open '{}' for writing!", path.string());
+			return false;
+		}
+
+		m_BufferSize = std::max(bufferSize, MinStreamBufferSize);
+		m_Buffer.reserve(m_BufferSize);
+		m_Position = 0;
+		m_IsFailed = false;
+		return true;
+	}
+
+	bool FileWriter::Close()
+	{
+		if (!m_File)
+			return true;
+
+		auto isWritten = Flush();
+		if (!PHYSFS_close(m_File))
+			isWritten = false;
+
+		m_File = nullptr;
+		m_Buffer = {};
+		m_Pending = {};
+		m_Position = 0;
+		RefreshIndex(GetWrittenPath(m_Path));
+		return isWritten;
+	}
+
+	bool FileWriter::Write(std::span<const std::byte> data)
+	{
+		if (!m_File)
+			return false;
+
+		m_Position += data.size();
+		while (!data.empty())
+		{
+			const auto count = std::min(data.size(), m_BufferSize - m_Buffer.size());
+			m_Buffer.insert(m_Buffer.end(), data.begin(), data.begin() + static_cast<ptrdiff_t>(count));
+			data = data.subspan(count);
+			if (m_Buffer.size() == m_BufferSize)
+				StartWrite();
+		}
+
+		std::lock_guard lock(m_Mutex);
+		return !m_IsFailed;
+	}
+
+	bool FileWriter::Flush()
+	{
+		if (!m_File)
+			return false;
+
+		if (!m_Buffer.empty())
+			StartWrite();
+		WaitWrite();
+
+		std::lock_guard lock(m_Mutex);
+		if (!PHYSFS_flush(m_File))
+			m_IsFailed = true;
+		return !m_IsFailed;
+	}
+
+	void FileWriter::StartWrite()
+	{
+		WaitWrite();
+		std::swap(m_Buffer, m_Pending);
+		m_Buffer.clear();
+		m_Buffer.reserve(m_BufferSize);
+		{
+			std::lock_guard lock(m_Mutex);
+			m_IsWriting = true;
+		}
+
+		RunAsync([this] {
+			const auto written = PHYSFS_writeBytes(m_File, m_Pending.data(), m_Pending.size());
+
+			std::lock_guard lock(m_Mutex);
+			if (written != static_cast<PHYSFS_sint64>(m_Pending.size()))
+				m_IsFailed = true;
+			m_IsWriting = false;
+			m_Condition.notify_all();
+		});
+	}
+
+	void FileWriter::WaitWrite()
+	{
+		std::unique_lock lock(m_Mutex);
+		m_Condition.wait(lock, [this] { return !m_IsWriting; });
+	}
+} // namespace oe::FileSystem
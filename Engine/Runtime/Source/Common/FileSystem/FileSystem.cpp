@@ -5,41 +5,211 @@
 
 #include "Oneiro/Common/FileSystem/FileSystem.hpp"
 
+#include "Oneiro/Common/FileSystem/Archive.hpp"
 #include "Oneiro/Common/FileSystem/Path.hpp"
 
 #include "physfs.h"
+
+#include <shared_mutex>
 namespace oe::FileSystem
 {
+	namespace
+	{
+		struct MountedArchive
+		{
+			Path path{};
+			std::string mountPoint{};
+			Ref<Archive> archive{};
+		};
+
+		// Read from IO threads and jobs while the main thread mounts, readers hold the Ref of the archive they found
+		std::vector<MountedArchive> s_Archives{};
+		std::shared_mutex s_ArchivesMutex{};
+		std::unique_ptr<AsyncReader> s_AsyncReader{};
+		std::unique_ptr<AsyncWriter> s_AsyncWriter{};
+		std::unique_ptr<DirectoryIndex> s_Index{};
+		// Kept after Shutdown, configs saved by static destructors still land next to the executable
+		std::filesystem::path s_BaseDirectory{};
+
+		// Strips the mount point, returns false when the path is outside of it
+		bool GetArchivePath(const MountedArchive& mounted, std::string_view& path) noexcept
+		{
+			if (mounted.mountPoint.empty())
+				return true;
+			if (!path.starts_with(mounted.mountPoint) || path.size() <= mounted.mountPoint.size() ||
+				path[mounted.mountPoint.size()] != '/')
+				return false;
+			path.remove_prefix(mounted.mountPoint.size() + 1);
+			return true;
+		}
+
+		// Path of a file inside of a mounted directory on the OS file system
+		std::string GetNativePath(std::string_view path, const char* realDirectory)
+		{
+			if (const std::string_view mountPoint = PHYSFS_getMountPoint(realDirectory); path.starts_with(mountPoint))
+				path.remove_prefix(mountPoint.size());
+			while (path.starts_with('/'))
+				path.remove_prefix(1);
+			return (std::filesystem::path(realDirectory) / path).string();
+		}
+
+		void IndexPhysFSDirectory(const std::string& directory)
+		{
+			auto** names = PHYSFS_enumerateFiles(directory.c_str());
+			if (!names)
+				return;
+
+			for (auto** name = names; *name; ++name)
+			{
+				const auto path = directory.empty() ? std::string{*name} : directory + '/' + *name;
+				PHYSFS_Stat stat{};
+				if (!PHYSFS_stat(path.c_str(), &stat))
+					continue;
+
+				const auto isDirectory = stat.filetype == PHYSFS_FILETYPE_DIRECTORY;
+				s_Index->Add(path, {isDirectory ? 0 : static_cast<uint64_t>(std::max<PHYSFS_sint64>(stat.filesize, 0)), stat.modtime,
+									isDirectory, false});
+				if (isDirectory)
+					IndexPhysFSDirectory(path);
+			}
+			PHYSFS_freeList(names);
+		}
+
+		// Archives mounted earlier win, the same as in FindArchived
+		void IndexArchive(const MountedArchive& mounted)
+		{
+			mounted.archive->ForEachEntry([&mounted](std::string_view name, const ArchiveEntry& entry) {
+				const auto path = mounted.mountPoint.empty() ? std::string{name} : mounted.mountPoint + '/' + std::string{name};
+				if (const auto stat = s_Index->Stat(path); !stat || !stat->isArchived)
+					s_Index->Add(path, {entry.uncompressedSize, 0, false, true});
+			});
+		}
+
+		// Files created around FileSystem, e.g. by other tools, are missing from the index until it is refreshed. Misses
+		// are checked on disk, and files found there are added to the index on the way.
+		bool IsIndexedOrOnDisk(const std::string& path)
+		{
+			if (s_Index && s_Index->IsExists(path))
+				return true;
+
+			PHYSFS_Stat stat{};
+			if (!PHYSFS_stat(path.c_str(), &stat))
+				return false;
+
+			std::error_code error{};
+			if (const auto* realDirectory = PHYSFS_getRealDir(path.c_str());
+				s_Index && realDirectory && std::filesystem::is_directory(realDirectory, error))
+				s_Index->Refresh(GetNativePath(path, realDirectory));
+			return true;
+		}
+
+		// Read through PhysFS that tells an empty file apart from a failed one
+		bool ReadPhysFS(const std::string& path, std::string& dest)
+		{
+			auto* file = PHYSFS_openRead(path.c_str());
+			if (!file)
+				return false;
+
+			const auto length = PHYSFS_fileLength(file);
+			dest.resize(static_cast<size_t>(std::max<PHYSFS_sint64>(length, 0)));
+			const auto isRead = length >= 0 && PHYSFS_readBytes(file, dest.data(), dest.size()) == length;
+			PHYSFS_close(file);
+			return isRead;
+		}
+
+		// Mounts are rare, so the index is simply rebuilt from everything that is mounted
+		void RebuildIndex()
+		{
+			s_Index->Clear();
+			IndexPhysFSDirectory("");
+			std::shared_lock lock{s_ArchivesMutex};
+			for (const auto& mounted : s_Archives)
+				IndexArchive(mounted);
+		}
+	} // namespace
+
 	void Init()
 	{
 		PHYSFS_init(nullptr);
+		s_BaseDirectory = PHYSFS_getBaseDir();
+		s_AsyncReader = std::make_unique<AsyncReader>();
+		s_AsyncWriter = std::make_unique<AsyncWriter>();
+		s_Index = std::make_unique<DirectoryIndex>();
 	}
 
 	void Shutdown()
 	{
+		// Commits the queued writes first, they refresh the index
+		s_AsyncWriter.reset();
+		s_AsyncReader.reset();
+		s_Index.reset();
+		std::unique_lock lock{s_ArchivesMutex};
+		s_Archives.clear();
 		if (IsInitialized())
 			PHYSFS_deinit();
 	}
 
 	void Mount(const Path& path, const std::string& mountPoint)
 	{
-		PHYSFS_mount(path.string().c_str(), mountPoint.c_str(), 1);
+		if (path.extension() == ".oepak")
+		{
+			auto archive = CreateRef<Archive>();
+			if (!archive->Open(path))
+				return;
+
+			auto normalizedMountPoint = Archive::NormalizePath(mountPoint);
+			while (normalizedMountPoint.ends_with('/'))
+				normalizedMountPoint.pop_back();
+			std::unique_lock lock{s_ArchivesMutex};
+			s_Archives.push_back({path, std::move(normalizedMountPoint), std::move(archive)});
+			IndexArchive(s_Archives.back());
+			return;
+		}
+
+		if (!PHYSFS_mount(path.string().c_str(), mountPoint.c_str(), 1))
+			return;
+
+		std::error_code error{};
+		if (std::filesystem::is_directory(path, error))
+			s_Index->AddMount(path, mountPoint);
+		RebuildIndex();
 	}
 
 	void UnMount(const Path& path)
 	{
+		if (path.extension() == ".oepak")
+		{
+			{
+				std::unique_lock lock{s_ArchivesMutex};
+				std::erase_if(s_Archives, [&path](const auto& mounted) { return mounted.path == path; });
+			}
+			RebuildIndex();
+			return;
+		}
+
 		PHYSFS_unmount(path.string().c_str());
+		s_Index->RemoveMount(path);
+		RebuildIndex();
 	}
 
 	std::string Read(const Path& path)
 	{
+		WaitAsyncWrite(path);
+
 		std::string pathString = path.string();
 		std::replace(pathString.begin(), pathString.end(), '\\', '/');
 
-		if (!FileSystem::IsExists(pathString))
+		Ref<Archive> archive{};
+		if (const auto* entry = FindArchived(path, archive))
 		{
-			return {};
+			std::string data(entry->uncompressedSize, '\0');
+			if (!archive->Extract(*entry, std::as_writable_bytes(std::span{data})))
+				return {};
+			return data;
 		}
+
+		if (!IsIndexedOrOnDisk(pathString))
+			return {};
 		const auto& file = PHYSFS_openRead(pathString.c_str());
 		if (file)
 		{
@@ -53,18 +223,216 @@ namespace oe::FileSystem
 		return {};
 	}
 
+	void ReadAsync(const Path& path, std::string& dest, ReadCallback callback)
+	{
+		WaitAsyncWrite(path);
+
+		Ref<Archive> archive{};
+		if (const auto* entry = FindArchived(path, archive))
+		{
+			s_AsyncReader->Run([archive = std::move(archive), entry, &dest, callback = std::move(callback)] {
+				dest.resize(entry->uncompressedSize);
+				callback(archive->Extract(*entry, std::as_writable_bytes(std::span{dest})));
+			});
+			return;
+		}
+
+		std::string pathString = path.string();
+		std::replace(pathString.begin(), pathString.end(), '\\', '/');
+
+		const auto* realDirectory = PHYSFS_getRealDir(pathString.c_str());
+		if (!realDirectory)
+		{
+			// Reported on the IO thread as well, callers never see the callback run inside of ReadAsync
+			s_AsyncReader->Run([callback = std::move(callback)] { callback(false); });
+			return;
+		}
+
+		// Files inside archives that PhysFS mounted can only be read through PhysFS
+		std::error_code error{};
+		if (!std::filesystem::is_directory(realDirectory, error))
+		{
+			s_AsyncReader->Run([pathString = std::move(pathString), &dest, callback = std::move(callback)] {
+				callback(ReadPhysFS(pathString, dest));
+			});
+			return;
+		}
+
+		s_AsyncReader->Read(GetNativePath(pathString, realDirectory), dest, std::move(callback));
+	}
+
+	void WaitAsyncReads()
+	{
+		s_AsyncReader->Wait();
+	}
+
+	std::optional<FileStat> Stat(const Path& path)
+	{
+		if (!s_Index)
+			return std::nullopt;
+		WaitAsyncWrite(path);
+		return s_Index->Stat(path.string());
+	}
+
+	std::vector<DirectoryEntry> List(const Path& directory)
+	{
+		if (!s_Index)
+			return {};
+		return s_Index->List(directory.string());
+	}
+
+	void RefreshIndex()
+	{
+		if (s_Index)
+			RebuildIndex();
+	}
+
+	void RefreshIndex(const std::filesystem::path& nativePath)
+	{
+		if (s_Index)
+			s_Index->Refresh(nativePath);
+	}
+
+	bool WatchChanges(bool isEnabled)
+	{
+		if (!s_Index)
+			return false;
+
+		if (!isEnabled)
+		{
+			s_Index->StopWatching();
+			return false;
+		}
+		return s_Index->Watch();
+	}
+
+	std::filesystem::path GetWrittenPath(std::string_view path)
+	{
+		while (path.starts_with('/'))
+			path.remove_prefix(1);
+		// Relative to the working directory before Init
+		return s_BaseDirectory / path;
+	}
+
+	void RunAsync(std::function<void()> task)
+	{
+		s_AsyncReader->Run(std::move(task));
+	}
+
+	MappedFile Map(const Path& path, EMapAccess access)
+	{
+		WaitAsyncWrite(path);
+
+		Ref<Archive> archive{};
+		if (const auto* entry = FindArchived(path, archive))
+		{
+			if (entry->codec != EArchiveCodec::NONE)
+			{
+				std::string data(entry->uncompressedSize, '\0');
+				if (!archive->Extract(*entry, std::as_writable_bytes(std::span{data})))
+					return {};
+				return MappedFile(std::move(data));
+			}
+
+			// The view holds the archive, so it stays valid after the archive is unmounted
+			const auto data = archive->Read(*entry);
+			MappedFile file(data, std::move(archive));
+			file.Advise(access);
+			return file;
+		}
+
+		std::string pathString = path.string();
+		std::replace(pathString.begin(), pathString.end(), '\\', '/');
+
+		const auto* realDirectory = PHYSFS_getRealDir(pathString.c_str());
+		if (!realDirectory)
+			return {};
+
+		std::error_code error{};
+		if (!std::filesystem::is_directory(realDirectory, error))
+		{
+			auto data = Read(path);
+			return data.empty() ? MappedFile{} : MappedFile(std::move(data));
+		}
+
+		MappedFile file{};
+		if (!file.Open(GetNativePath(pathString, realDirectory), access))
+			OE_CORE_ERROR("Failed to map '{}'!", pathString);
+		return file;
+	}
+
 	void Write(const Path& path, const uint8_t* data, size_t size)
+	{
+		WriteAsync(path, std::string(reinterpret_cast<const char*>(data), size));
+	}
+
+	std::shared_future<bool> WriteAsync(const Path& path, std::string data)
 	{
 		std::string pathString = path.string();
 		std::replace(pathString.begin(), pathString.end(), '\\', '/');
 
-		PHYSFS_setWriteDir(PHYSFS_getBaseDir());
-		const auto& file = PHYSFS_openWrite(pathString.c_str());
-		if (file)
+		const auto writtenPath = GetWrittenPath(pathString);
+		if (s_AsyncWriter)
+			return s_AsyncWriter->Write(writtenPath, std::move(data));
+
+		// Before Init or after Shutdown, e.g. configs saved by static destructors
+		std::promise<bool> promise{};
+		promise.set_value(AsyncWriter::WriteBlocking(writtenPath, data));
+		return promise.get_future().share();
+	}
+
+	void WaitAsyncWrites()
+	{
+		if (s_AsyncWriter)
+			s_AsyncWriter->Wait();
+	}
+
+	void WaitAsyncWrite(const Path& path)
+	{
+		if (s_AsyncWriter && !s_AsyncWriter->IsIdle())
+			s_AsyncWriter->Wait(GetWrittenPath(path.string()));
+	}
+
+	std::span<const std::byte> ReadArchived(const Path& path, Ref<Archive>& archive) noexcept
+	{
+		const auto* entry = FindArchived(path, archive);
+		if (!entry)
+			return {};
+		return archive->Read(*entry);
+	}
+
+	bool IsArchived(const Path& path) noexcept
+	{
+		Ref<Archive> archive{};
+		return FindArchived(path, archive) != nullptr;
+	}
+
+	const ArchiveEntry* FindArchived(const Path& path, Ref<Archive>& archive) noexcept
+	{
+		std::shared_lock lock{s_ArchivesMutex};
+		if (s_Archives.empty())
+			return nullptr;
+
+		std::string pathString = path.string();
+		std::replace(pathString.begin(), pathString.end(), '\\', '/');
+
+		std::string_view pathView = pathString;
+		while (pathView.starts_with('/'))
+			pathView.remove_prefix(1);
+
+		for (const auto& mounted : s_Archives)
 		{
-			PHYSFS_writeBytes(file, data, size);
-			PHYSFS_close(file);
+			auto archivePath = pathView;
+			if (!GetArchivePath(mounted, archivePath))
+				continue;
+
+			if (const auto* entry = mounted.archive->GetEntry(archivePath))
+			{
+				archive = mounted.archive;
+				return entry;
+			}
 		}
+		return nullptr;
 	}
 
 	bool IsInitialized() noexcept
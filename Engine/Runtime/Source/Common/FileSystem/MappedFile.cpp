@@ -0,0 +1,210 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#include "Oneiro/Common/FileSystem/MappedFile.hpp"
+
+#include <algorithm>
+#include <utility>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace oe::FileSystem
+{
+	namespace
+	{
+		size_t GetPageSize() noexcept
+		{
+#ifdef _WIN32
+			SYSTEM_INFO info{};
+			GetSystemInfo(&info);
+			return info.dwPageSize;
+#else
+			static const auto pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+			return pageSize;
+#endif
+		}
+
+		// Hints work on whole pages, views into an archive start anywhere inside of the mapping
+		std::span<const std::byte> AlignToPages(std::span<const std::byte> data, size_t offset, size_t size) noexcept
+		{
+			if (offset >= data.size())
+				return {};
+
+			const auto pageSize = GetPageSize();
+			const auto begin = reinterpret_cast<uintptr_t>(data.data() + offset) / pageSize * pageSize;
+			const auto end = reinterpret_cast<uintptr_t>(data.data() + offset + std::min(size, data.size() - offset));
+			return {reinterpret_cast<const std::byte*>(begin), static_cast<size_t>(end - begin)};
+		}
+	} // namespace
+
+	MappedFile::MappedFile(std::span<const std::byte> data, std::shared_ptr<const void> owner) noexcept
+		: m_Data(data.data()), m_Size(data.size()), m_IsOpen(true), m_Owner(std::move(owner))
+	{
+	}
+
+	MappedFile::MappedFile(std::string&& data) noexcept : m_Buffer(std::move(data)), m_IsOpen(true), m_IsBuffered(true)
+	{
+	}
+
+	MappedFile::MappedFile(MappedFile&& other) noexcept
+	{
+		*this = std::move(other);
+	}
+
+	MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+	{
+		if (this == &other)
+			return *this;
+
+		Close();
+		m_Buffer = std::move(other.m_Buffer);
+		m_Data = std::exchange(other.m_Data, nullptr);
+		m_Size = std::exchange(other.m_Size, 0);
+		m_IsOpen = std::exchange(other.m_IsOpen, false);
+		m_IsBuffered = std::exchange(other.m_IsBuffered, false);
+		m_IsOwningMapping = std::exchange(other.m_IsOwningMapping, false);
+		m_Owner = std::move(other.m_Owner);
+		return *this;
+	}
+
+	MappedFile::~MappedFile()
+	{
+		Close();
+	}
+
+	bool MappedFile::Open(const Path& path, EMapAccess access)
+	{
+		Close();
+
+#ifdef _WIN32
+		const DWORD accessFlag = access == EMapAccess::SEQUENTIAL ? FILE_FLAG_SEQUENTIAL_SCAN
+								 : access == EMapAccess::RANDOM	  ? FILE_FLAG_RANDOM_ACCESS
+																  : 0;
+		const auto file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+									  FILE_ATTRIBUTE_NORMAL | accessFlag, nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			return false;
+
+		LARGE_INTEGER fileSize{};
+		if (!GetFileSizeEx(file, &fileSize))
+		{
+			CloseHandle(file);
+			return false;
+		}
+
+		// Empty files can't be mapped
+		if (fileSize.QuadPart == 0)
+		{
+			CloseHandle(file);
+			m_IsOpen = true;
+			return true;
+		}
+
+		// The view keeps the mapping and the file alive, so both handles can be closed right away
+		const auto mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		CloseHandle(file);
+		if (!mapping)
+			return false;
+
+		const auto* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle(mapping);
+		if (!data)
+			return false;
+
+		m_Data = static_cast<const std::byte*>(data);
+		m_Size = static_cast<size_t>(fileSize.QuadPart);
+#else
+		const auto file = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+		if (file == -1)
+			return false;
+
+		struct stat fileStat
+		{
+		};
+		if (fstat(file, &fileStat) != 0)
+		{
+			close(file);
+			return false;
+		}
+
+		// Empty files can't be mapped
+		if (fileStat.st_size == 0)
+		{
+			close(file);
+			m_IsOpen = true;
+			return true;
+		}
+
+		auto* data = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+		close(file);
+		if (data == MAP_FAILED)
+			return false;
+
+		m_Data = static_cast<const std::byte*>(data);
+		m_Size = static_cast<size_t>(fileStat.st_size);
+#endif
+
+		m_IsOpen = true;
+		m_IsOwningMapping = true;
+		Advise(access);
+		return true;
+	}
+
+	void MappedFile::Close() noexcept
+	{
+		if (m_IsOwningMapping && m_Data)
+		{
+#ifdef _WIN32
+			UnmapViewOfFile(m_Data);
+#else
+			munmap(const_cast<std::byte*>(m_Data), m_Size);
+#endif
+		}
+
+		m_Buffer = {};
+		m_Data = nullptr;
+		m_Size = 0;
+		m_IsOpen = false;
+		m_IsBuffered = false;
+		m_IsOwningMapping = false;
+		m_Owner.reset();
+	}
+
+	void MappedFile::Advise(EMapAccess access) const noexcept
+	{
+#ifdef _WIN32
+		// Windows only takes the access pattern when the file is opened
+		(void)access;
+#else
+		const auto range = AlignToPages(GetData(), 0, m_Size);
+		if (m_IsBuffered || range.empty())
+			return;
+
+		const auto advice = access == EMapAccess::SEQUENTIAL ? MADV_SEQUENTIAL : access == EMapAccess::RANDOM ? MADV_RANDOM : MADV_NORMAL;
+		madvise(const_cast<std::byte*>(range.data()), range.size(), advice);
+#endif
+	}
+
+	void MappedFile::Prefetch(size_t offset, size_t size) const noexcept
+	{
+		const auto range = AlignToPages(GetData(), offset, size);
+		if (m_IsBuffered || range.empty())
+			return;
+
+#ifdef _WIN32
+		WIN32_MEMORY_RANGE_ENTRY entry{const_cast<std::byte*>(range.data()), range.size()};
+		PrefetchVirtualMemory(GetCurrentProcess(), 1, &entry, 0);
+#else
+		madvise(const_cast<std::byte*>(range.data()), range.size(), MADV_WILLNEED);
+#endif
+	}
+} // namespace oe::FileSystem
@@ -4,11 +4,20 @@
 //
 
 #include "Oneiro/Common/FileSystem/Path.hpp"
-
-#include "physfs.h"
+#include "Oneiro/Common/FileSystem/FileSystem.hpp"
 
 namespace oe::FileSystem
 {
+	namespace
+	{
+		// The engine never changes the working directory, so it is queried once
+		const std::string& GetCurrentPathString()
+		{
+			static const std::string currentPath = std::filesystem::current_path().string();
+			return currentPath;
+		}
+	} // namespace
+
 	Path::Path(std::filesystem::path path)
 	{
 		path.swap(*this);
@@ -18,7 +27,7 @@ namespace oe::FileSystem
 	{
 		if (IsLocal())
 			return *this;
-		return {this->string().erase(0, CurrentPath().string().size() + 1)};
+		return {this->string().erase(0, GetCurrentPathString().size() + 1)};
 	}
 
 	Path Path::GetGlobal() const
@@ -40,37 +49,35 @@ namespace oe::FileSystem
 
 	bool Path::IsGlobal() const noexcept
 	{
-		return this->string().find(CurrentPath().string()) != std::string::npos;
+		return this->string().find(GetCurrentPathString()) != std::string::npos;
 	}
 
 	oe::FileSystem::Path CurrentPath() noexcept
 	{
-		return {std::filesystem::current_path()};
+		return {GetCurrentPathString()};
 	}
 
 	void CreatePath(const oe::FileSystem::Path& path) noexcept
 	{
-		std::filesystem::create_directory(path);
+		std::error_code error{};
+		if (std::filesystem::create_directory(path, error))
+			RefreshIndex(path);
 	}
 
 	bool IsPath(const oe::FileSystem::Path& path) noexcept
 	{
-		PHYSFS_Stat stat{};
-		PHYSFS_stat(path.string().c_str(), &stat);
-		return stat.filetype == PHYSFS_FILETYPE_DIRECTORY;
+		const auto stat = Stat(path);
+		return stat && stat->isDirectory;
 	}
 
 	bool IsFile(const oe::FileSystem::Path& path) noexcept
 	{
-		PHYSFS_Stat stat{};
-		PHYSFS_stat(path.string().c_str(), &stat);
-		return stat.filetype == PHYSFS_FILETYPE_REGULAR;
+		const auto stat = Stat(path);
+		return stat && !stat->isDirectory;
 	}
 
 	bool IsExists(const oe::FileSystem::Path& path) noexcept
 	{
-		PHYSFS_Stat stat{};
-		PHYSFS_stat(path.string().c_str(), &stat);
-		return stat.filesize != -1;
+		return Stat(path).has_value();
 	}
 } // namespace oe::FileSystem
\ No newline at end of file
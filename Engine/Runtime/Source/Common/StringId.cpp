@@ -0,0 +1,64 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#include "Oneiro/Common/StringId.hpp"
+
+#include "Oneiro/Common/Loggger.hpp"
+
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_map>
+
+namespace oe
+{
+	namespace
+	{
+		// Function statics, ids are also built during static initialization. Strings are hashed over and over again
+		// but interned once, so lookups share the lock.
+		std::shared_mutex& GetInternMutex()
+		{
+			static std::shared_mutex mutex{};
+			return mutex;
+		}
+
+		std::unordered_map<uint64_t, std::string>& GetInternTable()
+		{
+			static std::unordered_map<uint64_t, std::string> table{};
+			return table;
+		}
+	} // namespace
+
+	std::string_view StringId::GetString() const
+	{
+#if OE_DEBUG
+		// Literals are hashed at compile time and can't be interned before
+		if (!m_Literal.empty())
+			Intern(m_Value, m_Literal);
+
+		std::shared_lock lock(GetInternMutex());
+		const auto& table = GetInternTable();
+		const auto& string = table.find(m_Value);
+		return string != table.end() ? std::string_view{string->second} : std::string_view{};
+#else
+		// Nothing is interned without OE_DEBUG (NDEBUG builds)
+		return {};
+#endif
+	}
+
+	void StringId::Intern(uint64_t value, std::string_view string) noexcept
+	{
+		{
+			std::shared_lock lock(GetInternMutex());
+			const auto& table = GetInternTable();
+			if (const auto& interned = table.find(value); interned != table.end() && interned->second == string)
+				return;
+		}
+
+		std::lock_guard lock(GetInternMutex());
+		const auto& [interned, isInserted] = GetInternTable().try_emplace(value, string);
+		if (!isInserted && interned->second != string)
+			OE_CORE_ERROR("StringId collision: '{}' and '{}' both hash to {:#x}!", interned->second, string, value);
+	}
+} // namespace oe
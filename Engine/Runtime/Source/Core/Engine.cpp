@@ -13,11 +13,41 @@
 #include "Oneiro/Rendering/ImGui/ImGuiManager.hpp"
 #include "Oneiro/Rendering/Renderer2D.hpp"
 
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <string_view>
+#include <thread>
+
 namespace oe
 {
-	void Engine::PreInit(IApplication* application)
+	void Engine::PreInit(IApplication* application, int argc, char** argv)
 	{
-		JobManager::Initialize();
+		const auto& properties = application->GetProperties().engine;
+
+		m_IsHeadless = properties.headless;
+		for (int i = 1; i < argc; ++i)
+		{
+			const std::string_view argument{argv[i]};
+			if (argument == "--headless")
+				m_IsHeadless = true;
+			else if (argument == "--cook" && i + 2 < argc)
+			{
+				// --cook <source directory> <output directory>: cooks the assets and exits without starting the game
+				m_CookSource = argv[++i];
+				m_CookOutput = argv[++i];
+				m_IsHeadless = true;
+			}
+			else if (argument == "--record-preload" && i + 1 < argc)
+			{
+				// --record-preload <manifest>: records the asset files read until shutdown, for --preload
+				m_PreloadRecordPath = argv[++i];
+			}
+			else if (argument == "--preload" && i + 1 < argc)
+				m_PreloadPath = argv[++i];
+		}
+
+		JobManager::Initialize(properties.jobThreads);
 
 		EngineApi::Initialize(application);
 
@@ -26,11 +56,29 @@ namespace oe
 		FileSystem::Init();
 		FileSystem::Mount(".", "/");
 
-		EngineApi::GetCVars()->Load("Engine", "/Configs/Engine.ini");
+		EngineApi::GetCVars()->Load("Engine"_sid, "/Configs/Engine.ini");
+
+		EngineApi::GetAssetsManager()->GetCooker()->SetCookOnDemand(properties.cookOnDemand);
+
+		// Started before the window, RHI and modules, so their initialization overlaps with the asset reads
+		if (!m_PreloadRecordPath.empty())
+			EngineApi::GetAssetsManager()->StartRecordingPreload();
+		else if (!m_PreloadPath.empty())
+			EngineApi::GetAssetsManager()->Preload(m_PreloadPath);
 	}
 
 	void Engine::Init()
 	{
+		if (!m_CookSource.empty())
+			return;
+
+		if (m_IsHeadless)
+		{
+			EngineApi::GetApplication()->OnPreInitialize();
+			EngineApi::GetApplication()->OnInitialize();
+			return;
+		}
+
 		EngineApi::GetModuleManager()->LoadModulesFromPath("Modules/");
 
 		const auto& window = EngineApi::GetWindowManager()->CreatePlatformWindow(EngineApi::GetApplication()->GetProperties().windowProperties);
@@ -52,8 +100,23 @@ namespace oe
 
 	void Engine::Run()
 	{
+		if (!m_CookSource.empty())
+		{
+			const auto stats = EngineApi::GetAssetsManager()->GetCooker()->CookDirectory(m_CookSource, m_CookOutput);
+			if (stats.failed)
+				OE_CORE_ERROR("Failed to cook {} assets!", stats.failed);
+			return;
+		}
+
 		m_IsRuntime = true;
 
+		if (m_IsHeadless)
+		{
+			RunHeadless();
+			m_IsRuntime = false;
+			return;
+		}
+
 		const auto& window = EngineApi::GetWindowManager()->GetPlatformWindow(0);
 
 		float lastFrame{};
@@ -67,11 +130,11 @@ namespace oe
 			m_DeltaTime = currentFrame - lastFrame;
 			lastFrame = currentFrame;
 
-			EngineApi::GetApplication()->OnLogicUpdate(m_DeltaTime);
+			EngineApi::GetAssetsManager()->Update();
 
-			EngineApi::GetWorldManager()->GetWorld()->UpdateRuntime(m_DeltaTime);
+			UpdateSimulation(m_DeltaTime);
 
-			Renderer2D::Draw();
+			Renderer2D::Draw(GetInterpolationAlpha());
 
 			window->Update();
 		}
@@ -81,25 +144,129 @@ namespace oe
 
 	void Engine::Shutdown()
 	{
-		EngineApi::GetApplication()->OnShutdown();
-		oe::EngineApi::GetAssetsManager()->CollectGarbage();
-		Renderer2D::Shutdown();
-		ImGuiManager::Shutdown();
+		if (m_CookSource.empty())
+			EngineApi::GetApplication()->OnShutdown();
+		if (!m_PreloadRecordPath.empty())
+			EngineApi::GetAssetsManager()->StopRecordingPreload(m_PreloadRecordPath);
+		oe::EngineApi::GetAssetsManager()->Shutdown();
+		if (!m_IsHeadless)
+		{
+			Renderer2D::Shutdown();
+			ImGuiManager::Shutdown();
+		}
 		EngineApi::GetCVars()->Save();
-		EngineApi::GetRHI()->Shutdown();
-		EngineApi::GetWindowManager()->GetPlatformWindow(0)->Destroy();
-		EngineApi::GetWindowManager()->Shutdown();
+		if (!m_IsHeadless)
+		{
+			EngineApi::GetRHI()->Shutdown();
+			EngineApi::GetWindowManager()->GetPlatformWindow(0)->Destroy();
+			EngineApi::GetWindowManager()->Shutdown();
+		}
 		EngineApi::Shutdown();
+		// Commits the queued writes
+		FileSystem::Shutdown();
 		JobManager::Shutdown();
 	}
 
+	void Engine::RunHeadless()
+	{
+		std::signal(SIGINT, OnShutdownSignal);
+		std::signal(SIGTERM, OnShutdownSignal);
+
+		const auto& properties = EngineApi::GetApplication()->GetProperties().engine;
+		const auto tickDuration =
+			std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / properties.fixedTickRate));
+		const auto maxLag = tickDuration * std::max(1u, properties.maxFixedSteps);
+
+		m_FixedDeltaTime = 1.0f / properties.fixedTickRate;
+		m_DeltaTime = m_FixedDeltaTime;
+
+		OE_CORE_INFO("Running headless at {} ticks per second", properties.fixedTickRate);
+
+		// Ticks are paced against absolute deadlines, so sleep jitter does not accumulate into drift
+		auto nextTick = std::chrono::steady_clock::now();
+		while (!m_IsShutdownRequested.load())
+		{
+			EngineApi::GetAssetsManager()->Update();
+			EngineApi::GetApplication()->OnLogicUpdate(m_FixedDeltaTime);
+			EngineApi::GetWorldManager()->UpdateWorlds(m_FixedDeltaTime);
+
+			nextTick += tickDuration;
+			const auto now = std::chrono::steady_clock::now();
+			if (now < nextTick)
+				std::this_thread::sleep_until(nextTick);
+			else if (now - nextTick > maxLag)
+				nextTick = now;
+		}
+
+		OE_CORE_INFO("Shutdown requested, stopping headless loop");
+	}
+
+	void Engine::OnShutdownSignal(int /*signal*/)
+	{
+		m_IsShutdownRequested.store(true);
+	}
+
+	void Engine::UpdateSimulation(float deltaTime)
+	{
+		const auto& properties = EngineApi::GetApplication()->GetProperties().engine;
+		auto* worldManager = EngineApi::GetWorldManager();
+
+		if (!properties.fixedTimeStep)
+		{
+			EngineApi::GetApplication()->OnLogicUpdate(deltaTime);
+			worldManager->UpdateWorlds(deltaTime);
+			m_FixedDeltaTime = deltaTime;
+			m_InterpolationAlpha = 1.0f;
+			return;
+		}
+
+		m_FixedDeltaTime = 1.0f / properties.fixedTickRate;
+		m_Accumulator += deltaTime;
+
+		uint32_t steps{};
+		while (m_Accumulator >= m_FixedDeltaTime && steps < properties.maxFixedSteps)
+		{
+			worldManager->StoreInterpolationState();
+			EngineApi::GetApplication()->OnLogicUpdate(m_FixedDeltaTime);
+			worldManager->UpdateWorlds(m_FixedDeltaTime);
+			m_Accumulator -= m_FixedDeltaTime;
+			++steps;
+		}
+
+		// Drop the time we could not catch up on, carrying it over would only make the next frames slower (spiral of death)
+		if (m_Accumulator >= m_FixedDeltaTime)
+			m_Accumulator = std::fmod(m_Accumulator, m_FixedDeltaTime);
+
+		m_InterpolationAlpha = m_Accumulator / m_FixedDeltaTime;
+	}
+
 	float Engine::GetDeltaTime() noexcept
 	{
 		return m_DeltaTime;
 	}
 
+	float Engine::GetFixedDeltaTime() noexcept
+	{
+		return m_FixedDeltaTime;
+	}
+
+	float Engine::GetInterpolationAlpha() noexcept
+	{
+		return m_InterpolationAlpha;
+	}
+
 	bool Engine::IsRuntime() noexcept
 	{
 		return m_IsRuntime;
 	}
+
+	bool Engine::IsHeadless() noexcept
+	{
+		return m_IsHeadless;
+	}
+
+	void Engine::RequestShutdown() noexcept
+	{
+		m_IsShutdownRequested.store(true);
+	}
 } // namespace oe
\ No newline at end of file
@@ -0,0 +1,9 @@
+#version 460 core
+
+layout(location = 0) out vec4 oColor;
+layout(location = 0) in vec2 Pos;
+
+void main()
+{
+    oColor = vec4(Pos, 0.0, 1.0);
+}
@@ -0,0 +1,16 @@
+#version 460 core
+
+layout(location = 0) in vec2 aPos;
+layout(location = 0) out vec2 Pos;
+
+// One transform per instance, interpolated between the last two fixed steps
+layout(std430, binding = 0) readonly buffer Transforms
+{
+    mat4 transforms[];
+};
+
+void main()
+{
+    Pos = aPos;
+    gl_Position = transforms[gl_InstanceID] * vec4(aPos, 0.0, 1.0);
+}
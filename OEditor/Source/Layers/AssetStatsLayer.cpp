@@ -0,0 +1,142 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#include "AssetStatsLayer.hpp"
+#include "Oneiro/Common/Assets/AssetsManager.hpp"
+#include "Oneiro/Common/EngineApi.hpp"
+
+#include "imgui.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+	struct AssetStatsRow
+	{
+		std::string name{};
+		std::string triggeredBy{};
+		oe::AssetLoadStats stats{};
+		oe::AssetMemoryUsage memory{};
+	};
+
+	std::string GetAssetStatsName(size_t hash)
+	{
+		const auto name = oe::StringId::FromValue(hash).GetString();
+		return name.empty() ? fmt::format("{:016x}", hash) : std::string{name};
+	}
+} // namespace
+
+void OEditor::AssetStatsLayer::OnCreate() {}
+
+void OEditor::AssetStatsLayer::OnDestroy() {}
+
+void OEditor::AssetStatsLayer::OnBegin() {}
+
+void OEditor::AssetStatsLayer::OnUpdate(float)
+{
+	auto* assetsManager = oe::EngineApi::GetAssetsManager();
+	ImGui::Begin("Asset Stats");
+
+	if (ImGui::Button("Dump JSON"))
+		assetsManager->DumpLoadStats("AssetLoadStats.json");
+	ImGui::SameLine();
+	if (ImGui::Button("Dump CSV"))
+		assetsManager->DumpLoadStats("AssetLoadStats.csv");
+	ImGui::SameLine();
+	ImGui::Checkbox("Failed only", &mShowFailedOnly);
+
+	std::vector<AssetStatsRow> rows{};
+	assetsManager->ForEachAsset([&](const oe::Ref<oe::IAsset>& asset) {
+		const auto& stats = asset->GetLoadStats();
+		if (stats.loadsCount == 0 || (mShowFailedOnly && !stats.isFailed))
+			return;
+		rows.push_back({GetAssetStatsName(asset->GetAssetInfo()->GetHash()),
+						stats.triggeredBy ? GetAssetStatsName(stats.triggeredBy) : std::string{}, stats, asset->GetMemoryUsage()});
+	});
+
+	constexpr auto flags = ImGuiTableFlags_Sortable | ImGuiTableFlags_Resizable | ImGuiTableFlags_RowBg | ImGuiTableFlags_ScrollY |
+						   ImGuiTableFlags_BordersInnerV;
+	if (ImGui::BeginTable("AssetStats", 10, flags))
+	{
+		ImGui::TableSetupScrollFreeze(0, 1);
+		ImGui::TableSetupColumn("Asset");
+		ImGui::TableSetupColumn("Triggered By");
+		ImGui::TableSetupColumn("Wait (ms)");
+		ImGui::TableSetupColumn("Read (ms)");
+		ImGui::TableSetupColumn("Decode (ms)");
+		ImGui::TableSetupColumn("Finalize (ms)");
+		ImGui::TableSetupColumn("Upload (ms)");
+		ImGui::TableSetupColumn("Total (ms)", ImGuiTableColumnFlags_DefaultSort | ImGuiTableColumnFlags_PreferSortDescending);
+		ImGui::TableSetupColumn("Disk (KiB)");
+		ImGui::TableSetupColumn("Memory (KiB)");
+		ImGui::TableHeadersRow();
+
+		const auto getColumn = [](const AssetStatsRow& row, int column) -> float {
+			switch (column)
+			{
+			case 2: return row.stats.queueWait;
+			case 3: return row.stats.read;
+			case 4: return row.stats.decode;
+			case 5: return row.stats.finalize;
+			case 6: return row.stats.upload;
+			case 8: return static_cast<float>(row.stats.diskSize);
+			case 9: return static_cast<float>(row.memory.cpu + row.memory.gpu);
+			default: return row.stats.GetTotal();
+			}
+		};
+
+		if (const auto* sortSpecs = ImGui::TableGetSortSpecs(); sortSpecs && sortSpecs->SpecsCount > 0)
+		{
+			const auto& spec = sortSpecs->Specs[0];
+			const auto isAscending = spec.SortDirection == ImGuiSortDirection_Ascending;
+			std::ranges::sort(rows, [&](const AssetStatsRow& lhs, const AssetStatsRow& rhs) {
+				if (spec.ColumnIndex < 2)
+				{
+					const auto& left = spec.ColumnIndex == 0 ? lhs.name : lhs.triggeredBy;
+					const auto& right = spec.ColumnIndex == 0 ? rhs.name : rhs.triggeredBy;
+					return isAscending ? left < right : left > right;
+				}
+				const auto left = getColumn(lhs, spec.ColumnIndex);
+				const auto right = getColumn(rhs, spec.ColumnIndex);
+				return isAscending ? left < right : left > right;
+			});
+		}
+
+		for (const auto& row : rows)
+		{
+			ImGui::TableNextRow();
+			ImGui::TableNextColumn();
+			if (row.stats.isFailed)
+				ImGui::TextColored({1.0f, 0.3f, 0.3f, 1.0f}, "%s", row.name.c_str());
+			else
+				ImGui::TextUnformatted(row.name.c_str());
+			ImGui::TableNextColumn();
+			ImGui::TextUnformatted(row.triggeredBy.c_str());
+			for (const auto value : {row.stats.queueWait, row.stats.read, row.stats.decode, row.stats.finalize, row.stats.upload,
+									 row.stats.GetTotal()})
+			{
+				ImGui::TableNextColumn();
+				ImGui::Text("%.3f", value);
+			}
+			ImGui::TableNextColumn();
+			ImGui::Text("%.1f", static_cast<float>(row.stats.diskSize) / 1024.0f);
+			ImGui::TableNextColumn();
+			ImGui::Text("%.1f", static_cast<float>(row.memory.cpu + row.memory.gpu) / 1024.0f);
+		}
+		ImGui::EndTable();
+	}
+	ImGui::End();
+}
+
+void OEditor::AssetStatsLayer::OnEvent(const oe::Event::Base& baseEvent)
+{
+	Layer::OnEvent(baseEvent);
+}
+
+void OEditor::AssetStatsLayer::OnEnd()
+{
+	Layer::OnEnd();
+}
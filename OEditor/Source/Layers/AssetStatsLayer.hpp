@@ -0,0 +1,29 @@
+//
+// Copyright (c) Oneiro Games. All rights reserved.
+// Licensed under the GNU General Public License, Version 3.0.
+//
+
+#pragma once
+
+#include "Oneiro/Common/Layer.hpp"
+
+namespace OEditor
+{
+	// Live load stats of every cached asset, sortable to find what makes a level load slowly
+	class AssetStatsLayer final : public oe::Layer
+	{
+	public:
+		using oe::Layer::Layer;
+
+		void OnCreate() override;
+		void OnDestroy() override;
+
+		void OnBegin() override;
+		void OnUpdate(float deltaTime) override;
+		void OnEvent(const oe::Event::Base& baseEvent) override;
+		void OnEnd() override;
+
+	private:
+		bool mShowFailedOnly{};
+	};
+} // namespace OEditor
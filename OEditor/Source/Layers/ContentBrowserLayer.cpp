@@ -6,7 +6,7 @@
 #include "ContentBrowserLayer.hpp"
 #include "../OEditorManager.hpp"
 
-#include "Oneiro/Common/FileSystem/Path.hpp"
+#include "Oneiro/Common/FileSystem/FileSystem.hpp"
 #include "Oneiro/Core/Assets/AssetsManager.hpp"
 #include "Oneiro/World/Components/AudioSourceComponent.hpp"
 #include "Oneiro/World/WorldManager.hpp"
@@ -15,7 +15,8 @@
 void OEditor::ContentBrowserLayer::OnCreate()
 {
 	LoadAssets();
-	mBasePath = oe::FileSystem::CurrentPath();
+	// The root of the virtual file system, listed from the directory index
+	mBasePath = {};
 	mCurrentPath = mBasePath;
 }
 
@@ -48,21 +49,20 @@ void OEditor::ContentBrowserLayer::OnUpdate(float /*deltaTime*/)
 
 	ImGui::Columns(columnCount, nullptr, false);
 
-	const auto& pathIterator = oe::FileSystem::Path::Iterator(mCurrentPath);
-	for (const auto& pathEntry : pathIterator)
+	for (const auto& entry : oe::FileSystem::List(mCurrentPath))
 	{
-		const oe::FileSystem::Path path{pathEntry.path()};
-		const auto& filenameString = path.filename().string();
+		const oe::FileSystem::Path path{mCurrentPath / entry.name};
+		const auto& filenameString = entry.name;
 
 		ImGui::PushID(filenameString.c_str());
-		const auto& icon = pathEntry.is_directory() ? mPathTexture : mFileTexture;
+		const auto& icon = entry.stat.isDirectory ? mPathTexture : mFileTexture;
 		ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0, 0, 0, 0));
 		ImGui::ImageButton(reinterpret_cast<void*>(static_cast<size_t>(icon->Get()->GetId())), {thumbnailSize, thumbnailSize}, {0, 1}, {1, 0});
 		ImGui::PopStyleColor();
 		if (ImGui::IsItemHovered() && ImGui::IsMouseDoubleClicked(ImGuiMouseButton_Left))
 		{
-			if (pathEntry.is_directory())
-				mCurrentPath /= path.filename();
+			if (entry.stat.isDirectory)
+				mCurrentPath /= entry.name;
 
 			if (path.extension() == ".oeproject")
 			{
@@ -73,7 +73,7 @@ void OEditor::ContentBrowserLayer::OnUpdate(float /*deltaTime*/)
 					if (oe::WorldManager::Get()->GetWorld()->IsLoaded())
 						oe::WorldManager::Get()->UnLoadWorld();
 				}
-				auto loaded = oe::Project::Load((oe::FileSystem::Path("/") / path.GetLocal()));
+				auto loaded = oe::Project::Load((oe::FileSystem::Path("/") / path));
 				Manager::Get()->SetActiveProject(loaded);
 				const auto& assetsPath = loaded->GetAssetsPath().string();
 				if (oe::FileSystem::IsFile("/" / loaded->GetWorldsPath() / loaded->GetStartWorldPath()))
@@ -100,7 +100,7 @@ void OEditor::ContentBrowserLayer::OnUpdate(float /*deltaTime*/)
 				oe::Project::SetActive(Manager::Get()->GetActiveProject());
 				const auto& assetsPath = oe::Project::GetActive()->GetAssetsPath().string();
 				oe::Project::GetActive()->SetAssetsPath((oe::FileSystem::Path("/") / assetsPath));
-				oe::WorldManager::Get()->LoadWorld((oe::FileSystem::Path("/") / path.GetLocal()));
+				oe::WorldManager::Get()->LoadWorld((oe::FileSystem::Path("/") / path));
 
 				auto filter = oe::WorldManager::Get()->GetWorld()->GetHandle()->filter<oe::World::Components::AudioSource>();
 				filter.each([this](flecs::entity /*flecsEntity*/, oe::World::Components::AudioSource& audioSource) {
@@ -118,7 +118,7 @@ void OEditor::ContentBrowserLayer::OnUpdate(float /*deltaTime*/)
 		const auto dragAndDropSrc = [=](const std::string& type) {
 			if (ImGui::BeginDragDropSource())
 			{
-				const auto& itemPathStr = path.GetLocal().string();
+				const auto& itemPathStr = path.string();
 				const auto& itemPath = itemPathStr.c_str();
 				ImGui::SetDragDropPayload(type.c_str(), itemPath, (std::strlen(itemPath) + 1) * sizeof(char));
 				ImGui::EndDragDropSource();
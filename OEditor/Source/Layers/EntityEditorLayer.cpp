@@ -6,6 +6,7 @@
 #include "EntityEditorLayer.hpp"
 #include "Oneiro/Common/FileSystem/FileSystem.hpp"
 #include "Oneiro/Common/Loggger.hpp"
+#include "Oneiro/Rendering/ImGui/ComponentInspector.hpp"
 
 #include "../OEditorManager.hpp"
 #include "ImGui/ImGuiUtils.hpp"
@@ -55,14 +56,13 @@ void OEditor::EntityEditorLayer::OnUpdate(float /*deltaTime*/)
 
 		ImGui::PopItemWidth();
 
-		DrawComponent<oe::World::Components::Transform>(
+		// Fields come from the component reflection, so new fields show up without editor changes. The reflection
+		// hints keep rotation in degrees and reset scale to 1
+		DrawComponent<oe::TransformComponent>(
 			"Transform", selectedEntity,
-			[this](const auto& component) {
-				DrawVec3Control("Position", component->position);
-				glm::vec3 rotation = glm::degrees(component->rotation);
-				DrawVec3Control("Rotation", rotation);
-				component->rotation = glm::radians(rotation);
-				DrawVec3Control("Scale", component->scale, 1.0f);
+			[&selectedEntity](const auto& component) {
+				if (oe::DrawComponentInspector(*component))
+					selectedEntity.template MarkModified<oe::TransformComponent>();
 			},
 			false, false);
 		DrawComponent<oe::World::Components::Quad>("Quad", selectedEntity, [](const auto& component) {
@@ -166,72 +166,6 @@ void OEditor::EntityEditorLayer::OnEvent(const oe::Event::Base& baseEvent) {}
 
 void OEditor::EntityEditorLayer::OnEnd() {}
 
-void OEditor::EntityEditorLayer::DrawVec3Control(const std::string& label, glm::vec3& values, float resetValue, float columnWidth)
-{
-	const auto& guiIo = ImGui::GetIO();
-	const auto& boldFont = guiIo.Fonts->Fonts[0];
-	const auto& lineHeight = GImGui->Font->FontSize + GImGui->Style.FramePadding.y * 2.0f;
-
-	const ImVec2 buttonSize{lineHeight + 3.0f, lineHeight};
-
-	ImGui::PushID(label.c_str());
-
-	ImGui::Columns(2);
-	ImGui::SetColumnWidth(0, columnWidth);
-	ImGui::Text("%s", label.c_str());
-	ImGui::NextColumn();
-
-	ImGui::PushMultiItemsWidths(3, ImGui::CalcItemWidth());
-	ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2{0, 0});
-
-	ImGui::PushStyleColor(ImGuiCol_Button, ImVec4{0.8f, 0.1f, 0.15f, 1.0f});
-	ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4{0.9f, 0.2f, 0.2f, 1.0f});
-	ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4{0.8f, 0.1f, 0.15f, 1.0f});
-	ImGui::PushFont(boldFont);
-	if (ImGui::Button("X", buttonSize))
-		values.x = resetValue;
-	ImGui::PopFont();
-	ImGui::PopStyleColor(3);
-
-	ImGui::SameLine();
-	ImGui::DragFloat("##X", &values.x, 0.1f, 0.0f, 0.0f, "%.2f");
-	ImGui::PopItemWidth();
-	ImGui::SameLine();
-
-	ImGui::PushStyleColor(ImGuiCol_Button, ImVec4{0.2f, 0.7f, 0.2f, 1.0f});
-	ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4{0.3f, 0.8f, 0.3f, 1.0f});
-	ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4{0.2f, 0.7f, 0.2f, 1.0f});
-	ImGui::PushFont(boldFont);
-	if (ImGui::Button("Y", buttonSize))
-		values.y = resetValue;
-	ImGui::PopFont();
-	ImGui::PopStyleColor(3);
-
-	ImGui::SameLine();
-	ImGui::DragFloat("##Y", &values.y, 0.1f, 0.0f, 0.0f, "%.2f");
-	ImGui::PopItemWidth();
-	ImGui::SameLine();
-
-	ImGui::PushStyleColor(ImGuiCol_Button, ImVec4{0.1f, 0.25f, 0.8f, 1.0f});
-	ImGui::PushStyleColor(ImGuiCol_ButtonHovered, ImVec4{0.2f, 0.35f, 0.9f, 1.0f});
-	ImGui::PushStyleColor(ImGuiCol_ButtonActive, ImVec4{0.1f, 0.25f, 0.8f, 1.0f});
-	ImGui::PushFont(boldFont);
-	if (ImGui::Button("Z", buttonSize))
-		values.z = resetValue;
-	ImGui::PopFont();
-	ImGui::PopStyleColor(3);
-
-	ImGui::SameLine();
-	ImGui::DragFloat("##Z", &values.z, 0.1f, 0.0f, 0.0f, "%.2f");
-	ImGui::PopItemWidth();
-
-	ImGui::PopStyleVar();
-
-	ImGui::Columns(1);
-
-	ImGui::PopID();
-}
-
 void OEditor::EntityEditorLayer::AcceptContentBrowserPayload(const std::string& type, const std::function<void(const std::string&)>& func) const
 {
 	if (const auto& payload = ImGui::AcceptDragDropPayload(type.c_str()))
@@ -6,6 +6,7 @@
 #pragma once
 
 #include "Oneiro/Common/Layer.hpp"
+#include "Oneiro/Common/TypeId.hpp"
 #include "WorldViewLayer.hpp"
 
 #include "imgui_internal.h"
@@ -31,7 +32,6 @@ namespace OEditor
 		template <typename T>
 		void DisplayAddComponentEntry(oe::World::Entity entity, const std::string& entryName);
 
-		void DrawVec3Control(const std::string& label, glm::vec3& values, float resetValue = 0.0f, float columnWidth = 80.0f);
 		template <typename T>
 		void DrawComponent(const std::string& name, oe::World::Entity entity, const std::function<void(T*)>& uiFunction, bool isRemovable = true,
 						   bool isCanChangeStatus = true);
@@ -64,7 +64,7 @@ namespace OEditor
 
 			ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2{4, 4});
 			ImGui::Separator();
-			const auto& open = ImGui::TreeNodeEx(reinterpret_cast<void*>(typeid(T).hash_code()), treeNodeFlags, "%s", name.c_str());
+			const auto& open = ImGui::TreeNodeEx(reinterpret_cast<void*>(static_cast<uintptr_t>(oe::GetTypeId<T>())), treeNodeFlags, "%s", name.c_str());
 			ImGui::PopStyleVar();
 			ImGui::SameLine(contentRegionAvailable.x - lineHeight * 0.5f);
 			if (ImGui::Button("+", ImVec2{lineHeight, lineHeight}))
@@ -81,15 +81,15 @@ namespace OEditor
 				ImGui::EndDisabled();
 
 				ImGui::BeginDisabled(!isCanChangeStatus);
-				if (component->IsActive())
+				if (entity.IsComponentActive<T>())
 				{
 					if (ImGui::MenuItem("Disable component"))
-						component->SetActive(false);
+						entity.SetComponentActive<T>(false);
 				}
 				else
 				{
 					if (ImGui::MenuItem("Enable component"))
-						component->SetActive(true);
+						entity.SetComponentActive<T>(true);
 				}
 				ImGui::EndDisabled();
 
@@ -98,7 +98,7 @@ namespace OEditor
 
 			if (open)
 			{
-				ImGui::BeginDisabled(!component->IsActive());
+				ImGui::BeginDisabled(!entity.IsActive() || !entity.IsComponentActive<T>());
 				uiFunction(component);
 				ImGui::EndDisabled();
 				ImGui::TreePop();
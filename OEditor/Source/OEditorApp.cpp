@@ -5,6 +5,7 @@
 
 #include "OEditorApp.hpp"
 
+#include "Layers/AssetStatsLayer.hpp"
 #include "Layers/ContentBrowserLayer.hpp"
 #include "Layers/DockSpaceLayer.hpp"
 #include "Layers/EditorSettingsLayer.hpp"
@@ -30,6 +31,7 @@ bool OEditor::OEditorApp::OnInitialize()
 	layerManager->PushLayer<ContentBrowserLayer>("ContentBrowserLayer");
 	layerManager->PushLayer<ProjectSettingsLayer>("ProjectSettingsLayer");
 	layerManager->PushLayer<EditorSettingsLayer>("EditorSettingsLayer");
+	layerManager->PushLayer<AssetStatsLayer>("AssetStatsLayer");
 
 	return true;
 }
@@ -62,7 +64,9 @@ std::unique_ptr<oe::IApplication> oe::CreateApplication()
 			.height = 900
 		},
 		.engine = {
-			.controlWorldState = false
+			.controlWorldState = false,
+			// The editor works on the sources
+			.cookOnDemand = true
 		},
 		.projectFilePath = "/OEditor.oeproject"
 	};
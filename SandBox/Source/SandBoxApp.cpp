@@ -7,11 +7,13 @@
 
 #include "Oneiro/Core/EntryPoint.hpp"
 
+#include "Oneiro/Common/Assets/TextureAsset.hpp"
 #include "Oneiro/Common/Assets/WorldAsset.hpp"
 
 bool SandBox::SandBoxApp::OnInitialize()
 {
-	oe::EngineApi::GetAssetsManager()->RegisterAssetsProvider<oe::WorldAssetsProvider>(typeid(oe::World).hash_code());
+	oe::EngineApi::GetAssetsManager()->RegisterAssetsProvider<oe::WorldAssetsProvider>(oe::GetTypeId<oe::World>());
+	oe::EngineApi::GetAssetsManager()->RegisterAssetsProvider<oe::TextureAssetsProvider>(oe::GetTypeId<oe::RHI::ITexture>());
 
 	world = oe::EngineApi::GetAssetsManager()->CreateAssetAndLoad<oe::World>("WORLD", false, oe::FileSystem::Path("world.oeworld"))->Get<oe::World>();
 	world->GetOrCreateEntity("test");